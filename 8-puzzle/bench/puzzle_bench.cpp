@@ -0,0 +1,382 @@
+#include "pattern_database.h"
+#include "search.h"
+#include "solver.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iterator>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+ * Solves seeded instance sets with every engine and heuristic and prints
+ * one JSON object: per combination the total time, node counts, memory
+ * and the solution lengths. Only the 3x3 set has reference optimal lengths,
+ * from a breadth-first search; the larger sets are checked against upper
+ * bounds that don't depend on the searches being measured. ARA* is also
+ * stopped at several deadlines, and its path checked against the bound it
+ * reports. The exit code is 2 when any check fails.
+ */
+
+namespace {
+
+const unsigned max_3x3_depth = 31;
+
+// Any 4x4 board is solved in at most 80 moves
+const std::size_t max_4x4_moves = 80;
+
+// ARA* starting weight and stop times, the first deadline passes before the search starts
+const double anytime_weight = 3;
+const std::chrono::microseconds anytime_deadlines[] = {
+        std::chrono::microseconds(-1), std::chrono::microseconds(200), std::chrono::milliseconds(2),
+        std::chrono::milliseconds(20), std::chrono::milliseconds(200)};
+
+struct Instance
+{
+    Board board;
+    // Known optimal length
+    std::optional<std::size_t> optimal;
+    // Length no optimal solution exceeds
+    std::size_t bound;
+};
+
+struct InstanceSet
+{
+    std::string name;
+    std::vector<Instance> instances;
+    std::vector<std::string> engines;
+    std::vector<Heuristic> heuristics;
+    // Check ARA* with the first heuristic, against A* where the optimal lengths are unknown
+    bool anytime = false;
+};
+
+struct Options
+{
+    std::uint64_t seed = 1;
+    unsigned count = 5;
+    unsigned threads = std::max(2u, std::thread::hardware_concurrency());
+    std::string pdb4_path;
+    std::string output_path;
+};
+
+void usage()
+{
+    std::cerr << "Usage: puzzle_bench [--seed N] [--count N] [--threads N] [--pdb4 FILE] [--output FILE]\n"
+              << "--count (at least 1) is the number of instances per 3x3 depth and per 4x4 and 5x5 set,\n"
+              << "--pdb4 is a 4x4 database from `8puzzle --build-pdb 4 FILE`, without it the\n"
+              << "random 4x4 set is skipped since only the database solves it in reasonable time.\n"
+              << "\"optimal\" counts optimal solutions where the optimal lengths are known (3x3), null otherwise;\n"
+              << "\"wrong\" lists instances with a non-optimal solution or one above the length bound\n"
+              << "(the walk length, or 80 moves for random 4x4 boards), for \"anytime\" the instances whose\n"
+              << "solution exceeds the reported suboptimality times the optimal length at some deadline.\n"
+              << "Exits with 2 if any \"wrong\" list is not empty." << std::endl;
+}
+
+Board to_board(const Cell * cells, const unsigned size)
+{
+    std::vector<std::vector<unsigned>> data(size, std::vector<unsigned>(size));
+    for (unsigned i = 0; i < size * size; ++i) {
+        data[i / size][i % size] = cells[i];
+    }
+    return Board(data);
+}
+
+// Every 3x3 board by its distance to the goal, the breadth-first order is the table order
+std::vector<std::vector<std::uint32_t>> boards_by_depth(const StateTable & table)
+{
+    std::vector<std::vector<std::uint32_t>> ans(max_3x3_depth + 1);
+    for (std::uint32_t i = 0; i < table.count(); ++i) {
+        ans[table.node(i).g].push_back(i);
+    }
+    return ans;
+}
+
+void breadth_first(StateTable & table, const unsigned size)
+{
+    const std::vector<Cell> goal = goal_cells(size);
+    table.reset(size);
+    const std::uint32_t root = table.insert(goal.data(), hash_cells(goal.data(), goal.size())).first;
+    table.node(root).g = 0;
+    table.node(root).blank = goal.size() - 1;
+    std::vector<Cell> cells(goal.size());
+    for (std::uint32_t i = 0; i < table.count(); ++i) {
+        std::copy(table.cells(i), table.cells(i) + cells.size(), cells.begin());
+        const SearchNode current = table.node(i);
+        for (Move move : {Up, Down, Left, Right}) {
+            unsigned target;
+            if (!apply_move(current.blank, move, size, target)) {
+                continue;
+            }
+            std::swap(cells[current.blank], cells[target]);
+            const auto [index, inserted] = table.insert(cells.data(), hash_cells(cells.data(), cells.size()));
+            if (inserted) {
+                table.node(index).g = current.g + 1;
+                table.node(index).blank = target;
+            }
+            std::swap(cells[current.blank], cells[target]);
+        }
+    }
+}
+
+InstanceSet depth_set(const Options & options)
+{
+    StateTable table;
+    breadth_first(table, 3);
+    const auto depths = boards_by_depth(table);
+    InstanceSet set{"3x3-depth", {}, {"astar", "bidirectional", "hda"},
+            {Heuristic::Manhattan, Heuristic::LinearConflict, Heuristic::PatternDatabase}, true};
+    std::mt19937_64 random(options.seed);
+    for (unsigned depth = 0; depth < depths.size(); ++depth) {
+        std::vector<std::uint32_t> boards = depths[depth];
+        const unsigned take = std::min<std::size_t>(options.count, boards.size());
+        for (unsigned k = 0; k < take; ++k) {
+            // Partial Fisher-Yates with the raw engine output, same picks with any library
+            std::swap(boards[k], boards[k + random() % (boards.size() - k)]);
+            set.instances.push_back({to_board(table.cells(boards[k]), 3), depth, depth});
+        }
+    }
+    return set;
+}
+
+std::string engine_name(const SolverOptions & options)
+{
+    if (options.algorithm == Algorithm::Bidirectional) {
+        return "bidirectional";
+    }
+    return options.threads > 1 ? "hda" : "astar";
+}
+
+std::string heuristic_name(const Heuristic heuristic)
+{
+    switch (heuristic) {
+        case Heuristic::Manhattan:
+            return "manhattan";
+        case Heuristic::LinearConflict:
+            return "linear-conflict";
+        case Heuristic::PatternDatabase:
+            return "pdb";
+    }
+    return "";
+}
+
+SolverOptions solver_options(const std::string & engine, const Heuristic heuristic, const Options & options)
+{
+    SolverOptions ans;
+    ans.heuristic = heuristic;
+    if (engine == "bidirectional") {
+        ans.algorithm = Algorithm::Bidirectional;
+    } else if (engine == "hda") {
+        ans.threads = options.threads;
+    }
+    return ans;
+}
+
+void print_wrong(std::ostream & out, const std::vector<std::size_t> & wrong)
+{
+    out << ", \"wrong\": [";
+    for (std::size_t i = 0; i < wrong.size(); ++i) {
+        out << (i == 0 ? "" : ", ") << wrong[i];
+    }
+    out << "]}";
+}
+
+/**
+ * @return number of wrong instances
+ */
+std::size_t run_set(std::ostream & out, bool & first, const InstanceSet & set, const SolverOptions & options)
+{
+    SearchContext context;
+    SearchStats total;
+    std::size_t optimal = 0, known = 0, moves = 0, max_memory = 0;
+    std::vector<std::size_t> wrong;
+    const auto started = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < set.instances.size(); ++i) {
+        const Instance & instance = set.instances[i];
+        const Solver solver(instance.board, options, context);
+        const bool is_optimal = instance.optimal && solver.moves() == *instance.optimal;
+        known += instance.optimal.has_value();
+        optimal += is_optimal;
+        if (solver.moves() > instance.bound || (instance.optimal && !is_optimal)) {
+            wrong.push_back(i);
+        }
+        moves += solver.moves();
+        total += solver.stats();
+        max_memory = std::max(max_memory, solver.stats().peak_memory);
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+
+    out << (first ? "" : ",") << "\n    {\"set\": \"" << set.name << "\""
+        << ", \"engine\": \"" << engine_name(options) << "\""
+        << ", \"heuristic\": \"" << heuristic_name(options.heuristic) << "\""
+        << ", \"threads\": " << options.threads
+        << ", \"instances\": " << set.instances.size()
+        << ", \"moves\": " << moves
+        << ", \"optimal\": ";
+    if (known == set.instances.size()) {
+        out << optimal;
+    } else {
+        out << "null";
+    }
+    out << ", \"seconds\": " << seconds
+        << ", \"expanded\": " << total.expanded
+        << ", \"generated\": " << total.generated
+        << ", \"duplicates\": " << total.duplicates
+        << ", \"nodes_per_second\": " << (seconds > 0 ? total.expanded / seconds : 0)
+        << ", \"max_peak_memory\": " << max_memory;
+    print_wrong(out, wrong);
+    first = false;
+    return wrong.size();
+}
+
+/**
+ * Stops ARA* at every deadline, mostly inside an iteration, and compares
+ * the path with the optimal one: from the set, or from A* with the same heuristic
+ * @return number of wrong instances
+ */
+std::size_t run_anytime(std::ostream & out, bool & first, const InstanceSet & set, const SolverOptions & options)
+{
+    SearchContext context;
+    const unsigned size = set.instances.front().board.size();
+    const HeuristicEvaluator heuristic(options.heuristic, size, options.database);
+    double max_ratio = 1;
+    std::vector<std::size_t> wrong;
+    for (std::size_t i = 0; i < set.instances.size(); ++i) {
+        const Instance & instance = set.instances[i];
+        const std::size_t optimal = instance.optimal ? *instance.optimal : Solver(instance.board, options, context).moves();
+        if (optimal == 0) {
+            continue;
+        }
+        const std::vector<Cell> start = pack_board(instance.board);
+        bool exceeded = false;
+        for (const auto delay : anytime_deadlines) {
+            double bound;
+            const std::size_t moves = anytime_astar(start, size, heuristic, anytime_weight,
+                    std::chrono::steady_clock::now() + delay, bound, context).size();
+            exceeded |= moves < optimal || moves > bound * optimal + 1e-9;
+            max_ratio = std::max(max_ratio, double(moves) / optimal);
+        }
+        if (exceeded) {
+            wrong.push_back(i);
+        }
+    }
+
+    out << (first ? "" : ",") << "\n    {\"set\": \"" << set.name << "\""
+        << ", \"engine\": \"anytime\""
+        << ", \"heuristic\": \"" << heuristic_name(options.heuristic) << "\""
+        << ", \"weight\": " << anytime_weight
+        << ", \"instances\": " << set.instances.size()
+        << ", \"deadlines\": " << std::size(anytime_deadlines)
+        << ", \"max_ratio\": " << max_ratio;
+    print_wrong(out, wrong);
+    first = false;
+    return wrong.size();
+}
+
+} // namespace
+
+int main(int argc, char * argv[])
+{
+    Options options;
+    try {
+        for (int i = 1; i < argc; ++i) {
+            const std::string arg = argv[i];
+            if (arg == "--seed" && i + 1 < argc) {
+                options.seed = std::stoull(argv[++i]);
+            } else if (arg == "--count" && i + 1 < argc && std::stoul(argv[i + 1]) > 0) {
+                options.count = std::stoul(argv[++i]);
+            } else if (arg == "--threads" && i + 1 < argc) {
+                options.threads = std::max(2ul, std::stoul(argv[++i]));
+            } else if (arg == "--pdb4" && i + 1 < argc) {
+                options.pdb4_path = argv[++i];
+            } else if (arg == "--output" && i + 1 < argc) {
+                options.output_path = argv[++i];
+            } else {
+                usage();
+                return 1;
+            }
+        }
+    } catch (const std::logic_error &) {
+        usage();
+        return 1;
+    }
+
+    std::shared_ptr<const PatternDatabase> pdb3 = std::make_shared<PatternDatabase>(
+            PatternDatabase::build(3, PatternDatabase::default_partition(3)));
+    std::shared_ptr<const PatternDatabase> pdb4;
+    if (!options.pdb4_path.empty()) {
+        try {
+            pdb4 = std::make_shared<PatternDatabase>(PatternDatabase::load(options.pdb4_path));
+        } catch (const std::exception & e) {
+            std::cerr << e.what() << std::endl;
+            return 1;
+        }
+    }
+
+    std::vector<InstanceSet> sets;
+    sets.push_back(depth_set(options));
+
+    BoardGenerator generator(options.seed);
+    InstanceSet walk4{"4x4-walk", {}, {"astar", "bidirectional", "hda"}, {Heuristic::Manhattan, Heuristic::LinearConflict}};
+    for (unsigned k = 0; k < options.count; ++k) {
+        walk4.instances.push_back({generator.walk(4, 60), std::nullopt, 60});
+    }
+    InstanceSet walk5{"5x5-walk", {}, {"astar", "bidirectional", "hda"}, {Heuristic::Manhattan, Heuristic::LinearConflict}};
+    for (unsigned k = 0; k < options.count; ++k) {
+        walk5.instances.push_back({generator.walk(5, 50), std::nullopt, 50});
+    }
+    // Random solvable boards like Korf's 100 instances, about 53 moves on average
+    InstanceSet korf{"4x4-random", {}, {"astar", "hda"}, {Heuristic::PatternDatabase}, true};
+    for (unsigned k = 0; k < options.count; ++k) {
+        korf.instances.push_back({generator(4, true), std::nullopt, max_4x4_moves});
+    }
+    if (pdb4) {
+        walk4.heuristics.push_back(Heuristic::PatternDatabase);
+    }
+    sets.push_back(std::move(walk4));
+    sets.push_back(std::move(walk5));
+    if (pdb4) {
+        sets.push_back(std::move(korf));
+    }
+
+    std::ofstream file;
+    if (!options.output_path.empty()) {
+        file.open(options.output_path);
+        if (!file) {
+            std::cerr << "Can't write " << options.output_path << std::endl;
+            return 1;
+        }
+    }
+    std::ostream & out = options.output_path.empty() ? std::cout : file;
+    out << "{\n  \"seed\": " << options.seed << ",\n  \"count\": " << options.count << ",\n  \"results\": [";
+    bool first = true;
+    std::size_t wrong = 0;
+    for (const auto & set : sets) {
+        if (set.instances.empty()) {
+            continue;
+        }
+        const std::size_t size = set.instances.front().board.size();
+        for (const auto & engine : set.engines) {
+            for (const Heuristic heuristic : set.heuristics) {
+                SolverOptions solver = solver_options(engine, heuristic, options);
+                solver.database = size == 3 ? pdb3 : pdb4;
+                wrong += run_set(out, first, set, solver);
+                out.flush();
+            }
+        }
+        if (set.anytime) {
+            SolverOptions solver = solver_options("astar", set.heuristics.front(), options);
+            solver.database = size == 3 ? pdb3 : pdb4;
+            wrong += run_anytime(out, first, set, solver);
+            out.flush();
+        }
+    }
+    out << "\n  ]\n}" << std::endl;
+    return wrong > 0 ? 2 : 0;
+}
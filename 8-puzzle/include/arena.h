@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+/**
+ * Bump allocator: memory is handed out from large blocks and is given
+ * back all at once by reset(), which keeps the blocks for the next use
+ */
+class Arena
+{
+public:
+    explicit Arena(std::size_t block_size = 1 << 20);
+
+    Arena(Arena && other) = default;
+
+    Arena & operator = (Arena && other) = default;
+
+    void * allocate(std::size_t bytes, std::size_t alignment = alignof(std::max_align_t));
+
+    void reset();
+
+    /**
+     * Bytes handed out since the last reset
+     */
+    std::size_t used() const
+    { return m_used; }
+
+    /**
+     * Bytes held in blocks
+     */
+    std::size_t reserved() const;
+
+private:
+    struct Block
+    {
+        std::unique_ptr<std::byte[]> data;
+        std::size_t size;
+    };
+
+    std::size_t m_block_size;
+    std::vector<Block> m_blocks;
+    std::size_t m_current = 0;
+    std::size_t m_offset = 0;
+    std::size_t m_used = 0;
+};
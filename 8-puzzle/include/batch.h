@@ -0,0 +1,19 @@
+#pragma once
+
+#include "solver.h"
+#include <istream>
+#include <vector>
+
+/**
+ * Reads boards written as their size followed by the rows until the end of input
+ * @return false if the input ends in the middle of a board or a board
+ * doesn't hold every tile from 0 to size^2 - 1 exactly once
+ */
+bool read_boards(std::istream & input, std::vector<Board> & boards);
+
+/**
+ * Solves every board on a pool of `threads` workers (0 means all hardware
+ * threads). Each worker reuses one search context for all its boards.
+ * @return solutions in the order of the boards
+ */
+std::vector<Solver> solve_batch(const std::vector<Board> & boards, const SolverOptions & options, unsigned threads = 0);
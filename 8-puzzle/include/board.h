@@ -1,11 +1,15 @@
 #pragma once
 
+#include <cstdint>
+#include <random>
 #include <string>
 #include <vector>
 
 class Board
 {
 private:
+    friend class BoardGenerator;
+
     std::vector<std::vector<unsigned>> table;
 
 public:
@@ -56,3 +60,42 @@ public:
     friend std::ostream & operator << (std::ostream & out, const Board & board)
     { return out << board.to_string(); }
 };
+
+/**
+ * Random boards from one seeded engine, the same seed gives
+ * the same boards with any standard library
+ */
+class BoardGenerator
+{
+public:
+    explicit BoardGenerator(std::uint64_t seed = std::random_device()());
+
+    /**
+     * Uniformly shuffled board, an unsolvable shuffle is fixed
+     * by swapping two tiles when `solvable` is set
+     */
+    Board operator () (unsigned size, bool solvable = false);
+
+    /**
+     * Goal board after `steps` random blank moves that never undo the previous one
+     */
+    Board walk(unsigned size, unsigned steps);
+
+private:
+    // Uniform in [0, bound)
+    std::uint64_t next(std::uint64_t bound);
+
+    std::mt19937_64 m_random;
+    std::vector<unsigned> m_cells;
+};
+
+/**
+ * Whether the row-major cells hold every tile from 0 to size^2 - 1 exactly once
+ */
+bool has_valid_tiles(const std::vector<unsigned> & cells, std::size_t size);
+
+/**
+ * Solvability of a row-major board in O(n log n) of the cell count,
+ * a board without valid tiles is unsolvable
+ */
+bool is_solvable(const std::vector<unsigned> & cells, std::size_t size);
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+class PatternDatabase;
+
+// Tile value in the packed representation used by the search
+using Cell = std::uint8_t;
+
+// Largest board whose tiles still fit into a Cell
+constexpr unsigned max_board_size = 16;
+
+enum class Heuristic
+{
+    Manhattan,
+    LinearConflict,
+    PatternDatabase,
+};
+
+/**
+ * Parses heuristic name ("manhattan", "linear-conflict" or "pdb")
+ * @return false if the name is unknown
+ */
+bool parse_heuristic(const std::string & name, Heuristic & heuristic);
+
+/**
+ * Sum of Manhattan distances of the tiles to their goal cells
+ * @param cells row-major board, 0 is the blank
+ * @param home cell of every tile in the target board, nullptr for the goal
+ */
+unsigned manhattan_distance(const Cell * cells, unsigned size, const Cell * home = nullptr);
+
+/**
+ * Manhattan distance plus two moves for every tile that has to leave
+ * its goal row (column) to let the other tiles of that line pass
+ */
+unsigned linear_conflict(const Cell * cells, unsigned size, const Cell * home = nullptr);
+
+class HeuristicEvaluator
+{
+public:
+    HeuristicEvaluator() = default;
+
+    /**
+     * Pattern database heuristic falls back to linear conflict when
+     * no database for this board size is supplied
+     */
+    HeuristicEvaluator(Heuristic heuristic, unsigned size, std::shared_ptr<const PatternDatabase> database = nullptr);
+
+    /**
+     * Estimates the distance to `target` instead of the goal,
+     * pattern databases only know the goal and give way to linear conflict
+     */
+    HeuristicEvaluator(Heuristic heuristic, unsigned size, std::shared_ptr<const PatternDatabase> database, const std::vector<Cell> & target);
+
+    Heuristic kind() const
+    { return m_heuristic; }
+
+    unsigned operator () (const Cell * cells) const;
+
+private:
+    Heuristic m_heuristic = Heuristic::Manhattan;
+    unsigned m_size = 0;
+    std::shared_ptr<const PatternDatabase> m_database;
+    std::vector<Cell> m_home;
+};
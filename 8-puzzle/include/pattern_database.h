@@ -0,0 +1,77 @@
+#pragma once
+
+#include "heuristic.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * Additive disjoint pattern databases: every table stores the exact number
+ * of moves of its own tiles needed to bring them home, blank moves over the
+ * other tiles are free, so the sum over a partition stays admissible.
+ */
+class PatternDatabase
+{
+public:
+    using Pattern = std::vector<unsigned>;
+
+    /**
+     * Standard partitions: 4-4 for 3x3, 6-6-3 for 4x4, 6-6-6-6 for 5x5,
+     * groups of six tiles in row-major order for the other sizes
+     */
+    static std::vector<Pattern> default_partition(unsigned size);
+
+    /**
+     * Fills the tables by a backward breadth-first search from the goal
+     * @param threads worker count, 0 means all hardware threads
+     */
+    static PatternDatabase build(unsigned size, const std::vector<Pattern> & patterns, unsigned threads = 0);
+
+    /**
+     * Maps a file written by save() into memory
+     * @throws std::runtime_error if the file can't be read or is malformed
+     */
+    static PatternDatabase load(const std::string & path);
+
+    /**
+     * Writes the header and the raw tables
+     * @return false on I/O error
+     */
+    bool save(const std::string & path) const;
+
+    PatternDatabase(PatternDatabase && other) noexcept;
+
+    PatternDatabase & operator = (PatternDatabase && other) noexcept;
+
+    PatternDatabase(const PatternDatabase & other) = delete;
+
+    PatternDatabase & operator = (const PatternDatabase & other) = delete;
+
+    ~PatternDatabase();
+
+    unsigned size() const
+    { return m_size; }
+
+    const std::vector<Pattern> & patterns() const
+    { return m_patterns; }
+
+    /**
+     * Sum of the table values for a row-major board
+     */
+    unsigned evaluate(const Cell * cells) const;
+
+private:
+    PatternDatabase() = default;
+
+    void set_patterns(unsigned size, std::vector<Pattern> patterns);
+
+    void release();
+
+    unsigned m_size = 0;
+    std::vector<Pattern> m_patterns;
+    std::vector<std::uint64_t> m_offsets;
+    std::vector<std::uint8_t> m_owned;
+    void * m_mapping = nullptr;
+    std::size_t m_mapping_size = 0;
+    const std::uint8_t * m_data = nullptr;
+};
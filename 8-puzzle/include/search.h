@@ -0,0 +1,206 @@
+#pragma once
+
+#include "arena.h"
+#include "board.h"
+#include "heuristic.h"
+#include "search_stats.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+// Direction the blank moves in, opposite directions differ in the lowest bit
+enum Move : std::uint8_t
+{
+    Up = 0,
+    Down = 1,
+    Left = 2,
+    Right = 3,
+    NoMove = 4,
+};
+
+inline Move opposite(const Move move)
+{ return static_cast<Move>(move ^ 1); }
+
+/**
+ * Cell the blank goes to after the move
+ * @return false if the move leaves the board
+ */
+bool apply_move(unsigned blank, Move move, unsigned size, unsigned & target);
+
+std::vector<Cell> pack_board(const Board & board);
+
+std::vector<Cell> goal_cells(unsigned size);
+
+std::uint64_t hash_cells(const Cell * cells, unsigned count);
+
+struct SearchNode
+{
+    static constexpr std::uint32_t no_parent = UINT32_MAX;
+
+    std::uint32_t parent;
+    std::uint32_t g;
+    std::uint32_t h;
+    std::uint8_t blank;
+    Move move;
+    bool closed;
+};
+
+/**
+ * Hash set of packed boards with a search node attached to each of them.
+ * Node, hash and board are stored together in fixed-size records that are
+ * allocated from an arena in chunks and addressed by node index.
+ */
+class StateTable
+{
+public:
+    explicit StateTable(unsigned size = 0);
+
+    /**
+     * Forgets all states, keeps the allocated memory
+     */
+    void reset(unsigned size);
+
+    /**
+     * Finds the board or appends a node for it
+     * @return node index and true if the node is new
+     */
+    std::pair<std::uint32_t, bool> insert(const Cell * cells, std::uint64_t hash);
+
+    /**
+     * @return node index or SearchNode::no_parent if the board is unknown
+     */
+    std::uint32_t find(const Cell * cells, std::uint64_t hash) const;
+
+    const Cell * cells(std::uint32_t index) const
+    { return reinterpret_cast<const Cell *>(record(index) + sizeof(Header)); }
+
+    SearchNode & node(std::uint32_t index)
+    { return header(index).node; }
+
+    const SearchNode & node(std::uint32_t index) const
+    { return header(index).node; }
+
+    std::size_t count() const
+    { return m_size; }
+
+    /**
+     * Bytes taken by the records and the hash slots
+     */
+    std::size_t memory() const
+    { return m_arena.used() + m_slots.size() * sizeof(std::uint32_t) + m_chunks.size() * sizeof(std::byte *); }
+
+private:
+    struct Header
+    {
+        SearchNode node;
+        std::uint64_t hash;
+    };
+
+    static constexpr unsigned chunk_bits = 12;
+
+    std::byte * record(std::uint32_t index) const
+    { return m_chunks[index >> chunk_bits] + (index & ((1u << chunk_bits) - 1)) * m_record; }
+
+    Header & header(std::uint32_t index) const
+    { return *reinterpret_cast<Header *>(record(index)); }
+
+    bool matches(std::uint32_t index, const Cell * cells, std::uint64_t hash) const;
+
+    void grow();
+
+    unsigned m_count = 0;
+    std::size_t m_record = 0;
+    std::size_t m_size = 0;
+    Arena m_arena;
+    std::vector<std::byte *> m_chunks;
+    std::vector<std::uint32_t> m_slots;
+};
+
+struct OpenEntry
+{
+    std::uint32_t f;
+    std::uint32_t g;
+    std::uint32_t node;
+};
+
+/**
+ * Weights are fixed point so that open list keys stay integers: f = g * weight_scale + weight * h
+ */
+constexpr std::uint32_t weight_scale = 256;
+
+inline std::uint32_t scale_weight(const double weight)
+{ return std::uint32_t(std::max(1.0, weight) * weight_scale); }
+
+// Lowest f first, deeper nodes first among equal f
+struct OpenOrder
+{
+    bool operator () (const OpenEntry & lhs, const OpenEntry & rhs) const
+    { return lhs.f > rhs.f || (lhs.f == rhs.f && lhs.g < rhs.g); }
+};
+
+/**
+ * Memory of one search, kept between searches so that solving
+ * many boards in a row doesn't reallocate anything
+ */
+struct SearchContext
+{
+    void reset(unsigned size);
+
+    /**
+     * Heuristic value of the board, timed when `timing` is set
+     */
+    unsigned evaluate(const HeuristicEvaluator & heuristic, const Cell * cells);
+
+    /**
+     * Records the open list size, the memory peak and the total time
+     */
+    void finish(std::chrono::steady_clock::time_point started);
+
+    bool timing = false;
+    SearchStats stats;
+    StateTable table;
+    std::vector<OpenEntry> open;
+    std::vector<Cell> scratch;
+    std::vector<Cell> goal;
+
+    // Second direction of the bidirectional search, created on first use
+    std::unique_ptr<SearchContext> backward;
+};
+
+/**
+ * A* from start to the goal, the nodes are left in context.table.
+ * Weighted A* when weight is above 1: the path is at most weight times longer than optimal
+ * @return goal node index
+ */
+std::uint32_t astar(const std::vector<Cell> & start, unsigned size, const HeuristicEvaluator & heuristic, SearchContext & context, double weight = 1);
+
+/**
+ * Anytime repairing A* (ARA*): weighted A* that lowers the weight after every
+ * solution and continues from the nodes of the previous iteration. Stops once
+ * the path is proven optimal or at the deadline, but not before the first path
+ * @param bound the returned path is at most bound times longer than optimal
+ * @return blank moves of the best path found
+ */
+std::vector<Move> anytime_astar(const std::vector<Cell> & start, unsigned size, const HeuristicEvaluator & heuristic, double weight, std::chrono::steady_clock::time_point deadline, double & bound, SearchContext & context);
+
+/**
+ * Hash-distributed A*: every board belongs to the thread its hash
+ * points to and is expanded only there, summed statistics go to context
+ * @return blank moves leading from start to the goal
+ */
+std::vector<Move> parallel_astar(const std::vector<Cell> & start, unsigned size, const HeuristicEvaluator & heuristic, unsigned threads, SearchContext & context);
+
+/**
+ * Meet-in-the-middle search (MM): both frontiers are ordered by max(f, 2g),
+ * the backward one estimates the distance to the start board
+ * @return blank moves leading from start to the goal
+ */
+std::vector<Move> bidirectional_search(const std::vector<Cell> & start, unsigned size, const HeuristicEvaluator & forward_heuristic, const HeuristicEvaluator & backward_heuristic, SearchContext & context);
+
+/**
+ * Blank moves along the parent links from the root to the node
+ */
+std::vector<Move> trace_moves(const StateTable & table, std::uint32_t index);
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+
+struct SearchStats
+{
+    // Successors produced by expansions
+    std::size_t generated = 0;
+
+    std::size_t expanded = 0;
+
+    // Successors dropped because the board was already reached not later
+    std::size_t duplicates = 0;
+
+    std::size_t peak_open = 0;
+
+    // Bytes of node records, hash slots and open lists at the end of the search
+    std::size_t peak_memory = 0;
+
+    // Filled only when timing is requested
+    double heuristic_seconds = 0;
+
+    double expansion_seconds = 0;
+
+    double seconds = 0;
+
+    double nodes_per_second() const
+    { return seconds > 0 ? expanded / seconds : 0; }
+
+    SearchStats & operator += (const SearchStats & other);
+};
@@ -1,32 +1,136 @@
 #pragma once
 
 #include "board.h"
+#include "heuristic.h"
+#include "search_stats.h"
+#include <chrono>
+#include <cstdint>
+#include <iterator>
+#include <memory>
 #include <vector>
 
+struct SearchContext;
+
+enum class Algorithm
+{
+    AStar,
+    Bidirectional,
+    // ARA*: weighted A* with a lowering weight, returns the best path found by the deadline
+    Anytime,
+};
+
+/**
+ * Boards larger than max_board_size are solved by A* over whole boards
+ * with the Manhattan distance, the options don't apply to them
+ */
+struct SolverOptions
+{
+    Algorithm algorithm = Algorithm::AStar;
+
+    Heuristic heuristic = Heuristic::LinearConflict;
+
+    // Used by Heuristic::PatternDatabase, must be built for the board size
+    std::shared_ptr<const PatternDatabase> database;
+
+    // f = g + weight * h for A* on one thread and for the first Anytime iteration,
+    // trades the path length for speed on boards the exact search can't solve
+    double weight = 1;
+
+    // Time budget of Algorithm::Anytime, zero runs it until the path is proven optimal
+    std::chrono::milliseconds deadline{0};
+
+    // More than one thread runs hash-distributed A* on the board, A* only
+    unsigned threads = 1;
+
+    // Measure heuristic and expansion time separately, costs two clock reads per heuristic call
+    bool timing = false;
+};
+
 class Solver
 {
 public:
+    /**
+     * Replays the stored blank moves, one board copy per iterator
+     */
+    class iterator
+    {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = Board;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const Board *;
+        using reference = const Board &;
+
+        iterator() = default;
+
+        reference operator * () const
+        { return m_board; }
+
+        pointer operator -> () const
+        { return &m_board; }
+
+        iterator & operator ++ ();
+
+        iterator operator ++ (int);
+
+        friend bool operator == (const iterator & lhs, const iterator & rhs)
+        { return lhs.m_step == rhs.m_step; }
+
+        friend bool operator != (const iterator & lhs, const iterator & rhs)
+        { return !(lhs == rhs); }
+
+    private:
+        friend class Solver;
+
+        iterator(const Solver * solver, std::size_t step);
+
+        const Solver * m_solver = nullptr;
+        std::size_t m_step = 0;
+        unsigned m_blank = 0;
+        Board m_board;
+    };
+
     explicit Solver(const Board & board);
 
+    Solver(const Board & board, const SolverOptions & options);
+
+    /**
+     * Searches in the given context, so it can be reused for the next board
+     */
+    Solver(const Board & board, const SolverOptions & options, SearchContext & context);
+
     Solver(const Solver & other) = default;
 
+    Solver(Solver && other) = default;
+
     Solver & operator = (const Solver & other) = default;
 
+    Solver & operator = (Solver && other) = default;
+
     std::size_t moves() const;
 
-    auto begin() const
-    { return m_moves.begin(); }
+    /**
+     * moves() is at most this many times the optimal number of moves, 1 for an optimal solution
+     */
+    double suboptimality() const
+    { return m_bound; }
+
+    const SearchStats & stats() const
+    { return m_stats; }
 
-    auto end() const
-    { return m_moves.end(); }
+    iterator begin() const;
+
+    iterator end() const;
 
 private:
-    std::vector<Board> m_moves;
+    // Blank move number `step`, moves are packed four per byte
+    unsigned move(std::size_t step) const;
 
-    std::vector<std::pair<int, int> > direction = {
-            {-1, 0},
-            {1, 0},
-            {0, -1},
-            {0, 1},
-    };
+    bool m_solved = false;
+    Board m_start;
+    unsigned m_blank = 0;
+    std::size_t m_length = 0;
+    double m_bound = 1;
+    std::vector<std::uint8_t> m_moves;
+    SearchStats m_stats;
 };
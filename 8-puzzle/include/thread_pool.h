@@ -0,0 +1,46 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class ThreadPool
+{
+public:
+    /**
+     * @param threads worker count, 0 means all hardware threads
+     */
+    explicit ThreadPool(unsigned threads = 0);
+
+    ThreadPool(const ThreadPool & other) = delete;
+
+    ThreadPool & operator = (const ThreadPool & other) = delete;
+
+    ~ThreadPool();
+
+    unsigned size() const
+    { return m_workers.size(); }
+
+    void submit(std::function<void()> task);
+
+    /**
+     * Blocks until all submitted tasks finish, rethrows the first exception thrown by a task
+     */
+    void wait();
+
+private:
+    void work();
+
+    std::vector<std::thread> m_workers;
+    std::deque<std::function<void()>> m_tasks;
+    std::mutex m_mutex;
+    std::condition_variable m_ready;
+    std::condition_variable m_done;
+    std::size_t m_running = 0;
+    bool m_stop = false;
+    std::exception_ptr m_error;
+};
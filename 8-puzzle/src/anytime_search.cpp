@@ -0,0 +1,207 @@
+#include "search.h"
+#include <algorithm>
+
+namespace {
+
+// Expansions between two deadline checks
+const std::size_t clock_period = 1024;
+
+/*
+ * ARA* keeps the nodes of the previous iteration: a closed node whose g
+ * gets lower is not reopened but set aside as inconsistent, and the next
+ * iteration starts from the open and the inconsistent nodes together.
+ */
+class AnytimeSearch
+{
+public:
+    AnytimeSearch(SearchContext & context, const HeuristicEvaluator & heuristic, const unsigned size, const double weight)
+        : m_context(context)
+        , m_heuristic(heuristic)
+        , m_size(size)
+        , m_weight(scale_weight(weight))
+    {}
+
+    std::vector<Move> run(const std::vector<Cell> & start, const std::chrono::steady_clock::time_point deadline, double & bound)
+    {
+        StateTable & table = m_context.table;
+        const std::uint32_t root = table.insert(start.data(), hash_cells(start.data(), start.size())).first;
+        table.node(root).h = m_context.evaluate(m_heuristic, start.data());
+        table.node(root).blank = std::find(start.begin(), start.end(), 0) - start.begin();
+        if (start == m_context.goal) {
+            m_found = root;
+        }
+        push(root);
+
+        std::vector<Move> path;
+        bound = 0;
+        while (true) {
+            const bool finished = improve(deadline);
+            if (m_found == SearchNode::no_parent) {
+                return path;
+            }
+            path = trace_moves(table, m_found);
+            // The weight only bounds the path once its iteration has run to the end
+            if (finished) {
+                m_proven = m_weight;
+            }
+            bound = double(table.node(m_found).g) / lower_bound();
+            if (m_proven != no_weight) {
+                bound = std::min(bound, double(m_proven) / weight_scale);
+            }
+            if (bound <= 1 || !finished || std::chrono::steady_clock::now() >= deadline) {
+                bound = std::max(bound, 1.0);
+                return path;
+            }
+            const std::uint32_t proven = std::uint32_t(bound * weight_scale);
+            m_weight = std::max(weight_scale, std::min(m_weight - weight_scale / 2, proven));
+            restart();
+        }
+    }
+
+private:
+    static constexpr std::uint32_t no_weight = UINT32_MAX;
+
+    std::uint32_t key(const SearchNode & node) const
+    { return node.g * weight_scale + m_weight * node.h; }
+
+    bool stale(const OpenEntry & entry) const
+    {
+        const SearchNode & node = m_context.table.node(entry.node);
+        return node.closed || node.g != entry.g;
+    }
+
+    void push(const std::uint32_t index)
+    {
+        auto & open = m_context.open;
+        open.push_back({key(m_context.table.node(index)), m_context.table.node(index).g, index});
+        std::push_heap(open.begin(), open.end(), OpenOrder());
+        m_context.stats.peak_open = std::max(m_context.stats.peak_open, open.size());
+    }
+
+    /**
+     * Expands until no open node can improve the found path for the current weight
+     * @return false when stopped by the deadline
+     */
+    bool improve(const std::chrono::steady_clock::time_point deadline)
+    {
+        StateTable & table = m_context.table;
+        auto & open = m_context.open;
+        auto & cells = m_context.scratch;
+        const unsigned count = m_size * m_size;
+        while (!open.empty()) {
+            const OpenEntry top = open.front();
+            if (stale(top)) {
+                std::pop_heap(open.begin(), open.end(), OpenOrder());
+                open.pop_back();
+                continue;
+            }
+            if (m_found != SearchNode::no_parent && table.node(m_found).g * weight_scale <= top.f) {
+                break;
+            }
+            if (m_found != SearchNode::no_parent && m_context.stats.expanded % clock_period == 0
+                    && std::chrono::steady_clock::now() >= deadline) {
+                return false;
+            }
+            std::pop_heap(open.begin(), open.end(), OpenOrder());
+            open.pop_back();
+
+            SearchNode & current = table.node(top.node);
+            std::copy(table.cells(top.node), table.cells(top.node) + count, cells.begin());
+            current.closed = true;
+            ++m_context.stats.expanded;
+
+            const unsigned blank = current.blank;
+            const Move arrived = current.move;
+            const std::uint32_t g = current.g + 1;
+            for (Move move : {Up, Down, Left, Right}) {
+                unsigned target;
+                if ((arrived != NoMove && move == opposite(arrived)) || !apply_move(blank, move, m_size, target)) {
+                    continue;
+                }
+                ++m_context.stats.generated;
+                std::swap(cells[blank], cells[target]);
+                const auto [index, inserted] = table.insert(cells.data(), hash_cells(cells.data(), count));
+                SearchNode & child = table.node(index);
+                if (inserted) {
+                    child.h = m_context.evaluate(m_heuristic, cells.data());
+                    child.blank = target;
+                    if (child.h == 0 && cells == m_context.goal) {
+                        m_found = index;
+                    }
+                }
+                if (inserted || g < child.g) {
+                    child.parent = top.node;
+                    child.g = g;
+                    child.move = move;
+                    if (child.closed) {
+                        m_inconsistent.push_back(index);
+                    } else {
+                        push(index);
+                    }
+                } else {
+                    ++m_context.stats.duplicates;
+                }
+                std::swap(cells[blank], cells[target]);
+            }
+        }
+        return true;
+    }
+
+    // Smallest g + h among the open and the inconsistent nodes, no path is shorter
+    double lower_bound() const
+    {
+        const StateTable & table = m_context.table;
+        std::uint32_t ans = table.node(m_found).g;
+        for (const auto & entry : m_context.open) {
+            if (!stale(entry)) {
+                ans = std::min(ans, entry.g + table.node(entry.node).h);
+            }
+        }
+        for (const std::uint32_t index : m_inconsistent) {
+            ans = std::min(ans, table.node(index).g + table.node(index).h);
+        }
+        return std::max(ans, 1u);
+    }
+
+    // Open list of the next iteration under the new weight, nothing is closed in it yet
+    void restart()
+    {
+        StateTable & table = m_context.table;
+        auto & open = m_context.open;
+        open.erase(std::remove_if(open.begin(), open.end(), [this](const OpenEntry & entry) { return stale(entry); }), open.end());
+        std::sort(m_inconsistent.begin(), m_inconsistent.end());
+        m_inconsistent.erase(std::unique(m_inconsistent.begin(), m_inconsistent.end()), m_inconsistent.end());
+        for (const std::uint32_t index : m_inconsistent) {
+            open.push_back({0, table.node(index).g, index});
+        }
+        m_inconsistent.clear();
+        for (auto & entry : open) {
+            entry.f = key(table.node(entry.node));
+        }
+        std::make_heap(open.begin(), open.end(), OpenOrder());
+        for (std::uint32_t i = 0; i < table.count(); ++i) {
+            table.node(i).closed = false;
+        }
+    }
+
+    SearchContext & m_context;
+    const HeuristicEvaluator & m_heuristic;
+    const unsigned m_size;
+    std::uint32_t m_weight;
+    // Weight of the last iteration that wasn't stopped by the deadline
+    std::uint32_t m_proven = no_weight;
+    std::uint32_t m_found = SearchNode::no_parent;
+    std::vector<std::uint32_t> m_inconsistent;
+};
+
+} // namespace
+
+std::vector<Move> anytime_astar(const std::vector<Cell> & start, const unsigned size, const HeuristicEvaluator & heuristic, const double weight, const std::chrono::steady_clock::time_point deadline, double & bound, SearchContext & context)
+{
+    const auto started = std::chrono::steady_clock::now();
+    context.reset(size);
+    AnytimeSearch search(context, heuristic, size, weight);
+    std::vector<Move> path = search.run(start, deadline, bound);
+    context.finish(started);
+    return path;
+}
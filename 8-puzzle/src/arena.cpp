@@ -0,0 +1,39 @@
+#include "arena.h"
+#include <algorithm>
+
+Arena::Arena(const std::size_t block_size)
+    : m_block_size(block_size)
+{}
+
+void * Arena::allocate(const std::size_t bytes, const std::size_t alignment)
+{
+    while (m_current < m_blocks.size()) {
+        const std::size_t offset = (m_offset + alignment - 1) / alignment * alignment;
+        if (offset + bytes <= m_blocks[m_current].size) {
+            m_used += offset + bytes - m_offset;
+            m_offset = offset + bytes;
+            return m_blocks[m_current].data.get() + offset;
+        }
+        ++m_current;
+        m_offset = 0;
+    }
+    const std::size_t size = std::max(m_block_size, bytes + alignment);
+    m_blocks.push_back({std::unique_ptr<std::byte[]>(new std::byte[size]), size});
+    return allocate(bytes, alignment);
+}
+
+void Arena::reset()
+{
+    m_current = 0;
+    m_offset = 0;
+    m_used = 0;
+}
+
+std::size_t Arena::reserved() const
+{
+    std::size_t ans = 0;
+    for (const auto & block : m_blocks) {
+        ans += block.size;
+    }
+    return ans;
+}
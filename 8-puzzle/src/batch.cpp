@@ -0,0 +1,53 @@
+#include "batch.h"
+#include "search.h"
+#include "thread_pool.h"
+#include <atomic>
+#include <optional>
+
+bool read_boards(std::istream & input, std::vector<Board> & boards)
+{
+    unsigned size;
+    while (input >> size) {
+        std::vector<unsigned> cells(size * size);
+        for (auto & cell : cells) {
+            if (!(input >> cell)) {
+                return false;
+            }
+        }
+        if (!has_valid_tiles(cells, size)) {
+            return false;
+        }
+        std::vector<std::vector<unsigned>> table(size);
+        for (unsigned i = 0; i < size; ++i) {
+            table[i].assign(cells.begin() + i * size, cells.begin() + (i + 1) * size);
+        }
+        boards.emplace_back(table);
+    }
+    return input.eof();
+}
+
+std::vector<Solver> solve_batch(const std::vector<Board> & boards, const SolverOptions & options, const unsigned threads)
+{
+    SolverOptions single = options;
+    single.threads = 1;
+    std::vector<std::optional<Solver>> solved(boards.size());
+    std::atomic<std::size_t> next{0};
+
+    ThreadPool pool(threads);
+    for (unsigned worker = 0; worker < pool.size(); ++worker) {
+        pool.submit([&] {
+            SearchContext context;
+            for (std::size_t i = next++; i < boards.size(); i = next++) {
+                solved[i].emplace(boards[i], single, context);
+            }
+        });
+    }
+    pool.wait();
+
+    std::vector<Solver> ans;
+    ans.reserve(boards.size());
+    for (auto & solver : solved) {
+        ans.push_back(std::move(*solver));
+    }
+    return ans;
+}
@@ -0,0 +1,199 @@
+#include "search.h"
+#include <algorithm>
+
+namespace {
+
+const std::uint32_t infinity = UINT32_MAX;
+
+/*
+ * One direction of the search. Open nodes are counted by g and by f
+ * so that the smallest values needed by the stopping rule are cheap.
+ */
+class Frontier
+{
+public:
+    Frontier(SearchContext & context, const HeuristicEvaluator & heuristic, const unsigned size, const std::vector<Cell> & root)
+        : m_context(context)
+        , m_heuristic(heuristic)
+        , m_size(size)
+    {
+        context.reset(size);
+        const std::uint32_t index = table().insert(root.data(), hash_cells(root.data(), size * size)).first;
+        SearchNode & node = table().node(index);
+        node.h = context.evaluate(heuristic, root.data());
+        node.blank = std::find(root.begin(), root.end(), 0) - root.begin();
+        push(index);
+    }
+
+    SearchContext & context()
+    { return m_context; }
+
+    StateTable & table()
+    { return m_context.table; }
+
+    bool empty()
+    {
+        drop_stale();
+        return m_context.open.empty();
+    }
+
+    // Smallest max(f, 2g) among the open nodes
+    std::uint32_t min_priority()
+    { return empty() ? infinity : m_context.open.front().f; }
+
+    std::uint32_t min_f() const
+    { return first_used(m_open_f); }
+
+    std::uint32_t min_g() const
+    { return first_used(m_open_g); }
+
+    std::uint32_t pop()
+    {
+        drop_stale();
+        auto & open = m_context.open;
+        std::pop_heap(open.begin(), open.end(), OpenOrder());
+        const std::uint32_t index = open.back().node;
+        open.pop_back();
+        SearchNode & node = table().node(index);
+        count(node, std::size_t(-1));
+        node.closed = true;
+        ++m_context.stats.expanded;
+        return index;
+    }
+
+    /**
+     * Reaches the board from the parent
+     * @return node index or infinity if the board was already reached not later
+     */
+    std::uint32_t relax(const Cell * cells, const std::uint32_t parent, const std::uint32_t g, const Move move, const unsigned blank)
+    {
+        ++m_context.stats.generated;
+        const auto [index, inserted] = table().insert(cells, hash_cells(cells, m_size * m_size));
+        SearchNode & node = table().node(index);
+        if (inserted) {
+            node.h = m_context.evaluate(m_heuristic, cells);
+            node.blank = blank;
+        } else if (g >= node.g) {
+            ++m_context.stats.duplicates;
+            return infinity;
+        } else if (!node.closed) {
+            count(node, std::size_t(-1));
+        }
+        node.parent = parent;
+        node.g = g;
+        node.move = move;
+        node.closed = false;
+        push(index);
+        return index;
+    }
+
+private:
+    static std::uint32_t first_used(const std::vector<std::size_t> & counts)
+    {
+        const auto it = std::find_if(counts.begin(), counts.end(), [](std::size_t count) { return count != 0; });
+        return it == counts.end() ? infinity : it - counts.begin();
+    }
+
+    void count(const SearchNode & node, const std::size_t delta)
+    {
+        const std::uint32_t f = node.g + node.h;
+        if (m_open_f.size() <= f) {
+            m_open_f.resize(f + 1);
+        }
+        if (m_open_g.size() <= node.g) {
+            m_open_g.resize(node.g + 1);
+        }
+        m_open_f[f] += delta;
+        m_open_g[node.g] += delta;
+    }
+
+    void push(const std::uint32_t index)
+    {
+        const SearchNode & node = table().node(index);
+        count(node, 1);
+        m_context.open.push_back({std::max(node.g + node.h, 2 * node.g), node.g, index});
+        std::push_heap(m_context.open.begin(), m_context.open.end(), OpenOrder());
+        m_context.stats.peak_open = std::max(m_context.stats.peak_open, m_context.open.size());
+    }
+
+    void drop_stale()
+    {
+        auto & open = m_context.open;
+        while (!open.empty() && (table().node(open.front().node).closed || table().node(open.front().node).g != open.front().g)) {
+            std::pop_heap(open.begin(), open.end(), OpenOrder());
+            open.pop_back();
+        }
+    }
+
+    SearchContext & m_context;
+    const HeuristicEvaluator & m_heuristic;
+    const unsigned m_size;
+    std::vector<std::size_t> m_open_f;
+    std::vector<std::size_t> m_open_g;
+};
+
+} // namespace
+
+std::vector<Move> bidirectional_search(const std::vector<Cell> & start, const unsigned size, const HeuristicEvaluator & forward_heuristic, const HeuristicEvaluator & backward_heuristic, SearchContext & context)
+{
+    const auto started = std::chrono::steady_clock::now();
+    if (!context.backward) {
+        context.backward = std::make_unique<SearchContext>();
+    }
+    context.backward->timing = context.timing;
+    Frontier forward(context, forward_heuristic, size, start);
+    Frontier backward(*context.backward, backward_heuristic, size, goal_cells(size));
+    std::vector<Cell> cells(size * size);
+
+    // Cost of the best path found so far and where its halves meet
+    std::uint32_t best = infinity;
+    std::uint32_t meet_forward = 0, meet_backward = 0;
+
+    while (!forward.empty() && !backward.empty()) {
+        const std::uint32_t priority = std::min(forward.min_priority(), backward.min_priority());
+        const std::uint32_t bound = std::max({priority, forward.min_f(), backward.min_f(), forward.min_g() + backward.min_g() + 1});
+        if (best <= bound) {
+            break;
+        }
+
+        const bool is_forward = forward.min_priority() <= backward.min_priority();
+        Frontier & side = is_forward ? forward : backward;
+        Frontier & other = is_forward ? backward : forward;
+        const std::uint32_t index = side.pop();
+        const SearchNode current = side.table().node(index);
+        std::copy(side.table().cells(index), side.table().cells(index) + size * size, cells.begin());
+
+        for (Move move : {Up, Down, Left, Right}) {
+            unsigned target;
+            if ((current.move != NoMove && move == opposite(current.move)) || !apply_move(current.blank, move, size, target)) {
+                continue;
+            }
+            std::swap(cells[current.blank], cells[target]);
+            const std::uint32_t child = side.relax(cells.data(), index, current.g + 1, move, target);
+            if (child != infinity) {
+                const std::uint32_t met = other.table().find(cells.data(), hash_cells(cells.data(), size * size));
+                if (met != SearchNode::no_parent && current.g + 1 + other.table().node(met).g < best) {
+                    best = current.g + 1 + other.table().node(met).g;
+                    meet_forward = is_forward ? child : met;
+                    meet_backward = is_forward ? met : child;
+                }
+            }
+            std::swap(cells[current.blank], cells[target]);
+        }
+    }
+
+    context.finish(started);
+    context.backward->finish(started);
+    context.stats += context.backward->stats;
+
+    std::vector<Move> path;
+    if (best == infinity) {
+        return path;
+    }
+    path = trace_moves(forward.table(), meet_forward);
+    const std::vector<Move> back = trace_moves(backward.table(), meet_backward);
+    for (auto it = back.rbegin(); it != back.rend(); ++it) {
+        path.push_back(opposite(*it));
+    }
+    return path;
+}
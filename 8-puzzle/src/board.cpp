@@ -20,19 +20,8 @@ Board Board::create_goal(const unsigned size)
 
 Board::Board(const unsigned size)
 {
-    table.resize(size, std::vector<unsigned>(size, 0));
-    std::vector <unsigned> cells;
-    for (size_t i = 0; i < size * size; cells.push_back(i++));
-
-    std::random_device rd;
-    std::mt19937 g(rd());
-    std::shuffle(std::begin(cells), std::end(cells), g);
-
-    for (size_t i = 0; i < size; ++i) {
-        for (size_t j = 0; j < size; ++j) {
-            table[i][j] = cells[i * size + j];
-        }
-    }
+    static thread_local BoardGenerator generator;
+    *this = generator(size);
 }
 
 Board::Board(const std::vector<std::vector<unsigned>> & data)
@@ -102,21 +91,12 @@ std::string Board::to_string() const
 
 bool Board::is_solvable() const
 {
-    unsigned ans = 0;
-    for (size_t i = 0; i < size() * size(); ++i) {
-        unsigned cur = table[i / size()][i % size()];
-        if (cur == 0 && size() % 2 == 0) {
-            ans += i / size() + 1;
-        } else {
-            for (size_t j = i + 1;  j < size() * size(); ++j) {
-                unsigned comp = table[j / size()][j % size()];
-                if (comp != 0 && comp < cur) {
-                    ++ans;
-                }
-            }
-        }
+    std::vector<unsigned> cells;
+    cells.reserve(size() * size());
+    for (const auto & row : table) {
+        cells.insert(cells.end(), row.begin(), row.end());
     }
-    return ans % 2 == 0;
+    return ::is_solvable(cells, size());
 }
 
 const std::vector<unsigned> & Board::operator [] (const std::size_t i) const
@@ -128,3 +108,108 @@ void Board::swap_cells (unsigned x1, unsigned y1, unsigned x2, unsigned y2)
 {
     std::swap(table[x1][y1], table[x2][y2]);
 }
+
+bool has_valid_tiles(const std::vector<unsigned> & cells, const std::size_t size)
+{
+    if (cells.size() != size * size) {
+        return false;
+    }
+    std::vector<bool> seen(cells.size(), false);
+    for (const unsigned cell : cells) {
+        if (cell >= cells.size() || seen[cell]) {
+            return false;
+        }
+        seen[cell] = true;
+    }
+    return true;
+}
+
+bool is_solvable(const std::vector<unsigned> & cells, const std::size_t size)
+{
+    if (!has_valid_tiles(cells, size)) {
+        return false;
+    }
+    // Inversions between tiles counted right to left with a Fenwick tree over tile values
+    std::vector<unsigned> tree(cells.size() + 1, 0);
+    std::size_t ans = 0;
+    for (size_t i = cells.size(); i-- > 0; ) {
+        unsigned cur = cells[i];
+        if (cur == 0) {
+            if (size % 2 == 0) {
+                ans += i / size + 1;
+            }
+            continue;
+        }
+        for (size_t k = cur - 1; k > 0; k -= k & -k) {
+            ans += tree[k];
+        }
+        for (size_t k = cur; k < tree.size(); k += k & -k) {
+            ++tree[k];
+        }
+    }
+    return ans % 2 == 0;
+}
+
+BoardGenerator::BoardGenerator(const std::uint64_t seed)
+    : m_random(seed)
+{}
+
+Board BoardGenerator::operator () (const unsigned size, const bool solvable)
+{
+    m_cells.resize(size * size);
+    for (size_t i = 0; i < m_cells.size(); ++i) {
+        m_cells[i] = i;
+    }
+    for (size_t i = m_cells.size(); i > 1; --i) {
+        std::swap(m_cells[i - 1], m_cells[next(i)]);
+    }
+    if (solvable && m_cells.size() > 2 && !::is_solvable(m_cells, size)) {
+        // Swapping two tiles flips the inversion parity
+        size_t first = m_cells[0] == 0 ? 1 : 0;
+        size_t second = m_cells[first + 1] == 0 ? first + 2 : first + 1;
+        std::swap(m_cells[first], m_cells[second]);
+    }
+
+    Board board;
+    board.table.assign(size, std::vector<unsigned>(size));
+    for (size_t i = 0; i < size; ++i) {
+        std::copy(m_cells.begin() + i * size, m_cells.begin() + (i + 1) * size, board.table[i].begin());
+    }
+    return board;
+}
+
+Board BoardGenerator::walk(const unsigned size, const unsigned steps)
+{
+    Board board = Board::create_goal(size);
+    if (size < 2) {
+        return board;
+    }
+    unsigned row = size - 1, column = size - 1;
+    int last = -1;
+    const int d_row[] = {-1, 1, 0, 0};
+    const int d_column[] = {0, 0, -1, 1};
+    for (unsigned step = 0; step < steps; ) {
+        const int move = next(4);
+        const unsigned cur_row = row + d_row[move];
+        const unsigned cur_column = column + d_column[move];
+        if ((move ^ 1) == last || cur_row >= size || cur_column >= size) {
+            continue;
+        }
+        board.swap_cells(row, column, cur_row, cur_column);
+        row = cur_row;
+        column = cur_column;
+        last = move;
+        ++step;
+    }
+    return board;
+}
+
+std::uint64_t BoardGenerator::next(const std::uint64_t bound)
+{
+    const std::uint64_t limit = UINT64_MAX - UINT64_MAX % bound;
+    std::uint64_t x;
+    do {
+        x = m_random();
+    } while (x >= limit);
+    return x % bound;
+}
\ No newline at end of file
@@ -0,0 +1,120 @@
+#include "heuristic.h"
+#include "pattern_database.h"
+#include <algorithm>
+#include <array>
+#include <utility>
+
+namespace {
+
+// Number of tiles that have to leave the line so that the rest are in goal order
+unsigned line_conflicts(const std::array<unsigned, max_board_size> & goal, unsigned count)
+{
+    std::array<unsigned, max_board_size> longest{};
+    unsigned best = 0;
+    for (unsigned i = 0; i < count; ++i) {
+        longest[i] = 1;
+        for (unsigned j = 0; j < i; ++j) {
+            if (goal[j] < goal[i]) {
+                longest[i] = std::max(longest[i], longest[j] + 1);
+            }
+        }
+        best = std::max(best, longest[i]);
+    }
+    return count - best;
+}
+
+} // namespace
+
+bool parse_heuristic(const std::string & name, Heuristic & heuristic)
+{
+    if (name == "manhattan") {
+        heuristic = Heuristic::Manhattan;
+    } else if (name == "linear-conflict") {
+        heuristic = Heuristic::LinearConflict;
+    } else if (name == "pdb") {
+        heuristic = Heuristic::PatternDatabase;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+unsigned manhattan_distance(const Cell * cells, const unsigned size, const Cell * home)
+{
+    unsigned ans = 0;
+    for (unsigned i = 0; i < size * size; ++i) {
+        if (cells[i] != 0) {
+            unsigned goal = home != nullptr ? home[cells[i]] : cells[i] - 1u;
+            unsigned row = i / size, column = i % size;
+            ans += std::max(goal / size, row) - std::min(goal / size, row)
+                    + std::max(goal % size, column) - std::min(goal % size, column);
+        }
+    }
+    return ans;
+}
+
+unsigned linear_conflict(const Cell * cells, const unsigned size, const Cell * home)
+{
+    unsigned conflicts = 0;
+    std::array<unsigned, max_board_size> goal{};
+    for (unsigned line = 0; line < size; ++line) {
+        unsigned count = 0;
+        for (unsigned column = 0; column < size; ++column) {
+            unsigned cell = cells[line * size + column];
+            unsigned target = home != nullptr ? home[cell] : cell - 1u;
+            if (cell != 0 && target / size == line) {
+                goal[count++] = target % size;
+            }
+        }
+        conflicts += line_conflicts(goal, count);
+
+        count = 0;
+        for (unsigned row = 0; row < size; ++row) {
+            unsigned cell = cells[row * size + line];
+            unsigned target = home != nullptr ? home[cell] : cell - 1u;
+            if (cell != 0 && target % size == line) {
+                goal[count++] = target / size;
+            }
+        }
+        conflicts += line_conflicts(goal, count);
+    }
+    return manhattan_distance(cells, size, home) + 2 * conflicts;
+}
+
+HeuristicEvaluator::HeuristicEvaluator(const Heuristic heuristic, const unsigned size, std::shared_ptr<const PatternDatabase> database)
+    : m_heuristic(heuristic)
+    , m_size(size)
+    , m_database(std::move(database))
+{
+    if (m_heuristic == Heuristic::PatternDatabase && (!m_database || m_database->size() != size)) {
+        m_heuristic = Heuristic::LinearConflict;
+        m_database.reset();
+    }
+}
+
+HeuristicEvaluator::HeuristicEvaluator(const Heuristic heuristic, const unsigned size, std::shared_ptr<const PatternDatabase> database, const std::vector<Cell> & target)
+    : HeuristicEvaluator(heuristic, size, std::move(database))
+{
+    m_home.resize(target.size());
+    for (unsigned i = 0; i < target.size(); ++i) {
+        m_home[target[i]] = i;
+    }
+    if (m_heuristic == Heuristic::PatternDatabase) {
+        m_heuristic = Heuristic::LinearConflict;
+        m_database.reset();
+    }
+}
+
+unsigned HeuristicEvaluator::operator () (const Cell * cells) const
+{
+    const Cell * home = m_home.empty() ? nullptr : m_home.data();
+    switch (m_heuristic) {
+        case Heuristic::Manhattan:
+            return manhattan_distance(cells, m_size, home);
+        case Heuristic::LinearConflict:
+            return linear_conflict(cells, m_size, home);
+        case Heuristic::PatternDatabase:
+            return m_database->evaluate(cells);
+    }
+    return 0;
+}
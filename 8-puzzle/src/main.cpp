@@ -1,12 +1,149 @@
+#include "batch.h"
+#include "pattern_database.h"
 #include "solver.h"
 
+#include <chrono>
+#include <fstream>
 #include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
 
-int main()
+namespace {
+
+void usage()
+{
+    std::cerr << "Usage: 8puzzle [--heuristic manhattan|linear-conflict|pdb] [--pdb FILE] [--threads N] [--batch] [--bidirectional] [--weight W] [--anytime MS] [--stats] [BOARD_FILE]\n"
+              << "       8puzzle --build-pdb SIZE FILE\n"
+              << "       8puzzle --generate SIZE COUNT SEED\n"
+              << "Board is read as its size followed by the rows, 0 is the blank.\n"
+              << "--batch solves every board of the input on N threads and prints their moves in input order,\n"
+              << "otherwise the first board is solved by hash-distributed A* on N threads.\n"
+              << "--weight runs weighted A*, --anytime runs ARA* from that weight for MS milliseconds (0 - until optimal),\n"
+              << "both print the factor by which the answer may exceed the optimal one." << std::endl;
+}
+
+void print_stats(std::ostream & out, const SearchStats & stats)
+{
+    out << "expanded: " << stats.expanded << "\n"
+        << "generated: " << stats.generated << "\n"
+        << "duplicates: " << stats.duplicates << "\n"
+        << "peak open: " << stats.peak_open << "\n"
+        << "peak memory: " << stats.peak_memory << " bytes\n"
+        << "heuristic time: " << stats.heuristic_seconds << " s\n"
+        << "expansion time: " << stats.expansion_seconds << " s\n"
+        << "total time: " << stats.seconds << " s\n"
+        << "nodes/sec: " << stats.nodes_per_second() << "\n";
+}
+
+} // namespace
+
+int main(int argc, char * argv[])
 {
-    Board board;
-    Solver solver(board);
+    SolverOptions options;
+    std::string pdb_path, board_path;
+    bool batch = false;
+    bool stats = false;
+    bool bounded = false;
+    try {
+        for (int i = 1; i < argc; ++i) {
+            const std::string arg = argv[i];
+            if (arg == "--heuristic" && i + 1 < argc) {
+                if (!parse_heuristic(argv[++i], options.heuristic)) {
+                    usage();
+                    return 1;
+                }
+            } else if (arg == "--pdb" && i + 1 < argc) {
+                pdb_path = argv[++i];
+            } else if (arg == "--threads" && i + 1 < argc) {
+                options.threads = std::stoul(argv[++i]);
+            } else if (arg == "--weight" && i + 1 < argc) {
+                options.weight = std::stod(argv[++i]);
+                bounded = true;
+            } else if (arg == "--anytime" && i + 1 < argc) {
+                options.algorithm = Algorithm::Anytime;
+                bounded = true;
+                options.deadline = std::chrono::milliseconds(std::stoul(argv[++i]));
+            } else if (arg == "--bidirectional") {
+                options.algorithm = Algorithm::Bidirectional;
+            } else if (arg == "--stats") {
+                stats = true;
+                options.timing = true;
+            } else if (arg == "--batch") {
+                batch = true;
+            } else if (arg == "--build-pdb" && i + 2 < argc) {
+                const unsigned size = std::stoul(argv[i + 1]);
+                const auto database = PatternDatabase::build(size, PatternDatabase::default_partition(size));
+                if (!database.save(argv[i + 2])) {
+                    std::cerr << "Can't write " << argv[i + 2] << std::endl;
+                    return 1;
+                }
+                return 0;
+            } else if (arg == "--generate" && i + 3 < argc) {
+                const unsigned size = std::stoul(argv[i + 1]);
+                const unsigned long count = std::stoul(argv[i + 2]);
+                BoardGenerator generator(std::stoull(argv[i + 3]));
+                for (unsigned long k = 0; k < count; ++k) {
+                    std::cout << size << "\n" << generator(size, true);
+                }
+                return 0;
+            } else if (arg[0] == '-' || !board_path.empty()) {
+                usage();
+                return 1;
+            } else {
+                board_path = arg;
+            }
+        }
+    } catch (const std::logic_error &) {
+        // Numbers that don't parse or don't fit
+        usage();
+        return 1;
+    }
+
+    std::vector<Board> boards;
+    std::ifstream file;
+    if (!board_path.empty()) {
+        file.open(board_path);
+    }
+    if (!read_boards(board_path.empty() ? std::cin : file, boards) || boards.empty()) {
+        std::cerr << "Can't read board" << std::endl;
+        return 1;
+    }
+    const Board & board = boards.front();
+
+    if (options.heuristic == Heuristic::PatternDatabase) {
+        try {
+            options.database = std::make_shared<const PatternDatabase>(pdb_path.empty()
+                    ? PatternDatabase::build(board.size(), PatternDatabase::default_partition(board.size()))
+                    : PatternDatabase::load(pdb_path));
+        } catch (const std::exception & e) {
+            std::cerr << e.what() << std::endl;
+            return 1;
+        }
+    }
+
+    if (batch) {
+        for (const auto & solver : solve_batch(boards, options, options.threads)) {
+            std::cout << solver.moves() << "\n";
+            if (bounded) {
+                std::cout << "suboptimality: " << solver.suboptimality() << "\n";
+            }
+            if (stats) {
+                print_stats(std::cout, solver.stats());
+            }
+        }
+        std::cout.flush();
+        return 0;
+    }
+
+    Solver solver(board, options);
     std::cout << solver.moves() << std::endl;
+    if (bounded) {
+        std::cout << "suboptimality: " << solver.suboptimality() << std::endl;
+    }
+    if (stats) {
+        print_stats(std::cout, solver.stats());
+    }
     /*
     for (const auto move : solver) {
         std::cout << move << std::endl;
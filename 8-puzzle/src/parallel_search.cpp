@@ -0,0 +1,267 @@
+#include "search.h"
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace {
+
+// Board generated by one thread for the thread that owns it
+struct Message
+{
+    std::uint64_t hash;
+    std::uint32_t g;
+    std::uint32_t parent;
+    std::uint16_t parent_owner;
+    std::uint8_t blank;
+    Move move;
+};
+
+struct Mailbox
+{
+    void clear()
+    {
+        messages.clear();
+        cells.clear();
+    }
+
+    std::vector<Message> messages;
+    std::vector<Cell> cells;
+};
+
+/*
+ * Every thread keeps its own table and open list. Termination is detected
+ * by a single counter of active threads plus undelivered messages: a thread
+ * is idle when it has nothing better than the incumbent solution to expand,
+ * and once the counter drops to zero no thread can ever get work again.
+ */
+class HashDistributedSearch
+{
+public:
+    HashDistributedSearch(const unsigned size, const HeuristicEvaluator & heuristic, const unsigned threads, const bool timing)
+        : m_size(size)
+        , m_count(size * size)
+        , m_heuristic(heuristic)
+        , m_goal(goal_cells(size))
+    {
+        for (unsigned i = 0; i < threads; ++i) {
+            m_workers.push_back(std::make_unique<Worker>());
+            m_workers.back()->context.reset(size);
+            m_workers.back()->context.timing = timing;
+            m_workers.back()->outboxes.resize(threads);
+        }
+    }
+
+    SearchStats stats() const
+    {
+        SearchStats ans;
+        for (const auto & worker : m_workers) {
+            ans += worker->context.stats;
+        }
+        return ans;
+    }
+
+    std::vector<Move> run(const std::vector<Cell> & start)
+    {
+        const std::uint64_t hash = hash_cells(start.data(), m_count);
+        const std::uint8_t blank = std::find(start.begin(), start.end(), 0) - start.begin();
+        Worker & owner = *m_workers[owner_of(hash)];
+        owner.inbox.messages.push_back({hash, 0, SearchNode::no_parent, 0, blank, NoMove});
+        owner.inbox.cells = start;
+        m_work = m_workers.size() + 1;
+
+        std::vector<std::thread> threads;
+        for (unsigned id = 0; id < m_workers.size(); ++id) {
+            threads.emplace_back([this, id] {
+                const auto started = std::chrono::steady_clock::now();
+                work(id);
+                m_workers[id]->context.finish(started);
+            });
+        }
+        for (auto & thread : threads) {
+            thread.join();
+        }
+
+        std::vector<Move> path;
+        if (m_incumbent == UINT32_MAX) {
+            return path;
+        }
+        unsigned worker = m_goal_owner;
+        std::uint32_t index = m_goal_index;
+        while (m_workers[worker]->context.table.node(index).move != NoMove) {
+            const Worker & owner = *m_workers[worker];
+            path.push_back(owner.context.table.node(index).move);
+            worker = owner.parent_owner[index];
+            index = owner.context.table.node(index).parent;
+        }
+        std::reverse(path.begin(), path.end());
+        return path;
+    }
+
+private:
+    struct Worker
+    {
+        SearchContext context;
+        std::vector<std::uint16_t> parent_owner;
+        std::vector<Mailbox> outboxes;
+        std::mutex mutex;
+        Mailbox inbox;
+    };
+
+    unsigned owner_of(const std::uint64_t hash) const
+    { return (hash >> 40) % m_workers.size(); }
+
+    void work(const unsigned id)
+    {
+        Worker & self = *m_workers[id];
+        Mailbox received;
+        std::vector<Cell> cells(m_count);
+        bool active = true;
+        while (true) {
+            {
+                std::lock_guard<std::mutex> lock(self.mutex);
+                std::swap(received, self.inbox);
+            }
+            if (!received.messages.empty()) {
+                if (!active) {
+                    m_work.fetch_add(1);
+                    active = true;
+                }
+                for (std::size_t i = 0; i < received.messages.size(); ++i) {
+                    receive(id, received.messages[i], received.cells.data() + i * m_count);
+                }
+                m_work.fetch_sub(received.messages.size());
+                received.clear();
+            }
+
+            auto & open = self.context.open;
+            const StateTable & table = self.context.table;
+            while (!open.empty() && (table.node(open.front().node).closed || table.node(open.front().node).g != open.front().g)) {
+                std::pop_heap(open.begin(), open.end(), OpenOrder());
+                open.pop_back();
+            }
+            if (!open.empty() && open.front().f < m_incumbent.load()) {
+                std::pop_heap(open.begin(), open.end(), OpenOrder());
+                const OpenEntry top = open.back();
+                open.pop_back();
+                expand(id, top.node, cells);
+                continue;
+            }
+
+            if (active) {
+                active = false;
+                m_work.fetch_sub(1);
+            }
+            if (m_work.load() == 0) {
+                return;
+            }
+            std::this_thread::yield();
+        }
+    }
+
+    void receive(const unsigned id, const Message & message, const Cell * cells)
+    {
+        Worker & self = *m_workers[id];
+        const auto [index, inserted] = self.context.table.insert(cells, message.hash);
+        SearchNode & node = self.context.table.node(index);
+        if (inserted) {
+            node.h = self.context.evaluate(m_heuristic, cells);
+            node.blank = message.blank;
+            self.parent_owner.push_back(message.parent_owner);
+        }
+        if (!inserted && message.g >= node.g) {
+            ++self.context.stats.duplicates;
+        } else {
+            node.parent = message.parent;
+            node.g = message.g;
+            node.move = message.move;
+            node.closed = false;
+            self.parent_owner[index] = message.parent_owner;
+            if (std::equal(m_goal.begin(), m_goal.end(), cells)) {
+                // A reached goal already bounds the search, no need to wait for its expansion
+                std::lock_guard<std::mutex> lock(m_goal_mutex);
+                if (message.g < m_incumbent.load()) {
+                    m_incumbent = message.g;
+                    m_goal_owner = id;
+                    m_goal_index = index;
+                }
+            } else if (message.g + node.h < m_incumbent.load()) {
+                auto & open = self.context.open;
+                open.push_back({message.g + node.h, message.g, index});
+                std::push_heap(open.begin(), open.end(), OpenOrder());
+                self.context.stats.peak_open = std::max(self.context.stats.peak_open, open.size());
+            }
+        }
+    }
+
+    void expand(const unsigned id, const std::uint32_t index, std::vector<Cell> & cells)
+    {
+        Worker & self = *m_workers[id];
+        StateTable & table = self.context.table;
+        SearchNode & current = table.node(index);
+        std::copy(table.cells(index), table.cells(index) + m_count, cells.begin());
+        current.closed = true;
+        ++self.context.stats.expanded;
+
+        const unsigned blank = current.blank;
+        const Move arrived = current.move;
+        const std::uint32_t g = current.g + 1;
+        for (Move move : {Up, Down, Left, Right}) {
+            unsigned target;
+            if ((arrived != NoMove && move == opposite(arrived)) || !apply_move(blank, move, m_size, target)) {
+                continue;
+            }
+            ++self.context.stats.generated;
+            std::swap(cells[blank], cells[target]);
+            const std::uint64_t hash = hash_cells(cells.data(), m_count);
+            const Message message = {hash, g, index, std::uint16_t(id), std::uint8_t(target), move};
+            const unsigned owner = owner_of(hash);
+            if (owner == id) {
+                receive(id, message, cells.data());
+            } else {
+                Mailbox & outbox = self.outboxes[owner];
+                outbox.messages.push_back(message);
+                outbox.cells.insert(outbox.cells.end(), cells.begin(), cells.end());
+            }
+            std::swap(cells[blank], cells[target]);
+        }
+
+        for (unsigned owner = 0; owner < self.outboxes.size(); ++owner) {
+            Mailbox & outbox = self.outboxes[owner];
+            if (outbox.messages.empty()) {
+                continue;
+            }
+            m_work.fetch_add(outbox.messages.size());
+            Worker & other = *m_workers[owner];
+            {
+                std::lock_guard<std::mutex> lock(other.mutex);
+                other.inbox.messages.insert(other.inbox.messages.end(), outbox.messages.begin(), outbox.messages.end());
+                other.inbox.cells.insert(other.inbox.cells.end(), outbox.cells.begin(), outbox.cells.end());
+            }
+            outbox.clear();
+        }
+    }
+
+    const unsigned m_size;
+    const unsigned m_count;
+    const HeuristicEvaluator & m_heuristic;
+    const std::vector<Cell> m_goal;
+    std::vector<std::unique_ptr<Worker>> m_workers;
+    std::atomic<std::size_t> m_work{0};
+    std::atomic<std::uint32_t> m_incumbent{UINT32_MAX};
+    std::mutex m_goal_mutex;
+    unsigned m_goal_owner = 0;
+    std::uint32_t m_goal_index = SearchNode::no_parent;
+};
+
+} // namespace
+
+std::vector<Move> parallel_astar(const std::vector<Cell> & start, const unsigned size, const HeuristicEvaluator & heuristic, unsigned threads, SearchContext & context)
+{
+    threads = std::clamp(threads, 1u, unsigned(UINT16_MAX));
+    HashDistributedSearch search(size, heuristic, threads, context.timing);
+    std::vector<Move> path = search.run(start);
+    context.stats = search.stats();
+    return path;
+}
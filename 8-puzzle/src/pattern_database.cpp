@@ -0,0 +1,460 @@
+#include "pattern_database.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+const char file_magic[8] = {'8', 'P', 'D', 'B', 'v', '1', '\0', '\0'};
+
+const std::uint64_t data_alignment = 64;
+
+const std::uint8_t unknown = 0xFF;
+
+// Saturates at UINT64_MAX, so a table too large to exist never looks small
+std::uint64_t table_entries(const unsigned cells, const std::size_t tiles)
+{
+    std::uint64_t entries = 1;
+    for (std::size_t i = 0; i < tiles; ++i) {
+        if (entries > UINT64_MAX / (cells - i)) {
+            return UINT64_MAX;
+        }
+        entries *= cells - i;
+    }
+    return entries;
+}
+
+// Index of the tile placement among all placements of `count` distinct tiles on `cells` cells
+std::uint64_t rank(const Cell * position, const std::size_t count, const unsigned cells)
+{
+    std::uint64_t index = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        unsigned smaller = 0;
+        for (std::size_t j = 0; j < i; ++j) {
+            smaller += position[j] < position[i];
+        }
+        index = index * (cells - i) + position[i] - smaller;
+    }
+    return index;
+}
+
+unsigned neighbours(const unsigned cell, const unsigned size, std::array<unsigned, 4> & out)
+{
+    unsigned count = 0;
+    if (cell >= size) {
+        out[count++] = cell - size;
+    }
+    if (cell + size < size * size) {
+        out[count++] = cell + size;
+    }
+    if (cell % size != 0) {
+        out[count++] = cell - 1;
+    }
+    if (cell % size != size - 1) {
+        out[count++] = cell + 1;
+    }
+    return count;
+}
+
+template <class Expand>
+std::vector<std::uint64_t> expand_parallel(const std::vector<std::uint64_t> & states, const unsigned threads, const Expand & expand)
+{
+    const std::size_t min_chunk = 1 << 12;
+    const std::size_t workers_count = std::max<std::size_t>(1, std::min<std::size_t>(threads, states.size() / min_chunk));
+    const std::size_t chunk = (states.size() + workers_count - 1) / workers_count;
+    std::vector<std::vector<std::uint64_t>> found(workers_count);
+    std::vector<std::thread> workers;
+    for (std::size_t t = 0; t < workers_count; ++t) {
+        workers.emplace_back([&, t] {
+            const std::size_t last = std::min(states.size(), (t + 1) * chunk);
+            for (std::size_t i = t * chunk; i < last; ++i) {
+                expand(states[i], found[t]);
+            }
+        });
+    }
+    for (auto & worker : workers) {
+        worker.join();
+    }
+    std::vector<std::uint64_t> ans;
+    for (const auto & part : found) {
+        ans.insert(ans.end(), part.begin(), part.end());
+    }
+    return ans;
+}
+
+/*
+ * Backward 0-1 breadth-first search over (tile positions, blank) states.
+ * A blank move over a foreign tile costs nothing, a move of a pattern
+ * tile costs one; the table keeps the cheapest cost over all blank cells.
+ * States are packed as `bits`-wide cell numbers: pattern tiles, then the blank.
+ */
+class PatternSearch
+{
+public:
+    PatternSearch(const unsigned size, const PatternDatabase::Pattern & pattern, const unsigned threads, std::uint8_t * table)
+        : m_size(size)
+        , m_cells(size * size)
+        , m_count(pattern.size())
+        , m_threads(threads)
+        , m_entries(table_entries(m_cells, m_count))
+        , m_table(table)
+    {
+        while ((1u << m_bits) < m_cells) {
+            ++m_bits;
+        }
+        if (m_bits * (m_count + 1) > 64) {
+            throw std::invalid_argument("pattern is too large");
+        }
+        const std::uint64_t words = (m_entries * m_cells + 63) / 64;
+        m_visited.reset(new std::atomic<std::uint64_t>[words]);
+        for (std::uint64_t i = 0; i < words; ++i) {
+            m_visited[i].store(0, std::memory_order_relaxed);
+        }
+        m_values.reset(new std::atomic<std::uint8_t>[m_entries]);
+        for (std::uint64_t i = 0; i < m_entries; ++i) {
+            m_values[i].store(unknown, std::memory_order_relaxed);
+        }
+
+        std::array<Cell, 64> position{};
+        for (std::size_t i = 0; i < m_count; ++i) {
+            position[i] = pattern[i] - 1;
+        }
+        m_goal = pack(position.data(), m_cells - 1);
+    }
+
+    void run()
+    {
+        std::vector<std::uint64_t> current = {m_goal};
+        visit(m_goal);
+        for (unsigned cost = 0; !current.empty(); ++cost) {
+            const std::uint8_t value = std::min<unsigned>(cost, unknown - 1);
+            std::vector<std::uint64_t> frontier = current;
+            while (!frontier.empty()) {
+                frontier = expand_parallel(frontier, m_threads, [this](std::uint64_t state, std::vector<std::uint64_t> & out) {
+                    expand(state, false, out);
+                });
+                current.insert(current.end(), frontier.begin(), frontier.end());
+            }
+            current = expand_parallel(current, m_threads, [this, value](std::uint64_t state, std::vector<std::uint64_t> & out) {
+                record(state, value);
+                expand(state, true, out);
+            });
+        }
+        for (std::uint64_t i = 0; i < m_entries; ++i) {
+            m_table[i] = m_values[i].load(std::memory_order_relaxed);
+        }
+    }
+
+private:
+    std::uint64_t pack(const Cell * position, const unsigned blank) const
+    {
+        std::uint64_t state = blank;
+        for (std::size_t i = m_count; i-- > 0; ) {
+            state = (state << m_bits) | position[i];
+        }
+        return state;
+    }
+
+    unsigned unpack(std::uint64_t state, Cell * position) const
+    {
+        const std::uint64_t mask = (std::uint64_t(1) << m_bits) - 1;
+        for (std::size_t i = 0; i < m_count; ++i) {
+            position[i] = state & mask;
+            state >>= m_bits;
+        }
+        return state;
+    }
+
+    bool visit(const std::uint64_t state)
+    {
+        std::array<Cell, 64> position{};
+        const unsigned blank = unpack(state, position.data());
+        const std::uint64_t bit = rank(position.data(), m_count, m_cells) * m_cells + blank;
+        const std::uint64_t mask = std::uint64_t(1) << (bit % 64);
+        return (m_visited[bit / 64].fetch_or(mask, std::memory_order_relaxed) & mask) == 0;
+    }
+
+    void record(const std::uint64_t state, const std::uint8_t value)
+    {
+        std::array<Cell, 64> position{};
+        unpack(state, position.data());
+        auto & entry = m_values[rank(position.data(), m_count, m_cells)];
+        std::uint8_t expected = unknown;
+        entry.compare_exchange_strong(expected, value, std::memory_order_relaxed);
+    }
+
+    // Follows either the free blank moves or the moves of pattern tiles
+    void expand(const std::uint64_t state, const bool pattern_moves, std::vector<std::uint64_t> & out)
+    {
+        std::array<Cell, 64> position{};
+        const unsigned blank = unpack(state, position.data());
+        std::array<unsigned, 4> next{};
+        const unsigned count = neighbours(blank, m_size, next);
+        for (unsigned k = 0; k < count; ++k) {
+            const auto tile = std::find(position.begin(), position.begin() + m_count, next[k]);
+            const bool is_pattern = tile != position.begin() + m_count;
+            if (is_pattern != pattern_moves) {
+                continue;
+            }
+            std::uint64_t moved;
+            if (is_pattern) {
+                *tile = blank;
+                moved = pack(position.data(), next[k]);
+                *tile = next[k];
+            } else {
+                moved = pack(position.data(), next[k]);
+            }
+            if (visit(moved)) {
+                out.push_back(moved);
+            }
+        }
+    }
+
+    const unsigned m_size;
+    const unsigned m_cells;
+    const std::size_t m_count;
+    const unsigned m_threads;
+    const std::uint64_t m_entries;
+    std::uint8_t * const m_table;
+    unsigned m_bits = 1;
+    std::uint64_t m_goal = 0;
+    std::unique_ptr<std::atomic<std::uint64_t>[]> m_visited;
+    std::unique_ptr<std::atomic<std::uint8_t>[]> m_values;
+};
+
+template <class T>
+void write_value(std::ofstream & out, const T & value)
+{
+    out.write(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+template <class T>
+bool read_value(const std::uint8_t * data, const std::size_t size, std::size_t & offset, T & value)
+{
+    if (offset + sizeof(value) > size) {
+        return false;
+    }
+    std::memcpy(&value, data + offset, sizeof(value));
+    offset += sizeof(value);
+    return true;
+}
+
+} // namespace
+
+std::vector<PatternDatabase::Pattern> PatternDatabase::default_partition(const unsigned size)
+{
+    if (size == 3) {
+        return {{1, 2, 3, 4}, {5, 6, 7, 8}};
+    }
+    if (size == 4) {
+        return {{1, 5, 6, 9, 10, 13}, {7, 8, 11, 12, 14, 15}, {2, 3, 4}};
+    }
+    if (size == 5) {
+        return {{1, 2, 5, 6, 7, 12}, {3, 4, 8, 9, 13, 14}, {10, 11, 15, 16, 20, 21}, {17, 18, 19, 22, 23, 24}};
+    }
+    std::vector<Pattern> ans;
+    for (unsigned tile = 1; tile < size * size; ++tile) {
+        if ((tile - 1) % 6 == 0) {
+            ans.emplace_back();
+        }
+        ans.back().push_back(tile);
+    }
+    return ans;
+}
+
+void PatternDatabase::set_patterns(const unsigned size, std::vector<Pattern> patterns)
+{
+    if (size < 2 || size > max_board_size) {
+        throw std::invalid_argument("unsupported board size");
+    }
+    std::vector<bool> used(size * size, false);
+    std::uint64_t offset = 0;
+    m_offsets.clear();
+    for (const auto & pattern : patterns) {
+        for (unsigned tile : pattern) {
+            if (tile == 0 || tile >= size * size || used[tile]) {
+                throw std::invalid_argument("patterns must be disjoint sets of tiles");
+            }
+            used[tile] = true;
+        }
+        m_offsets.push_back(offset);
+        offset += table_entries(size * size, pattern.size());
+    }
+    m_offsets.push_back(offset);
+    m_size = size;
+    m_patterns = std::move(patterns);
+}
+
+PatternDatabase PatternDatabase::build(const unsigned size, const std::vector<Pattern> & patterns, unsigned threads)
+{
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    PatternDatabase ans;
+    ans.set_patterns(size, patterns);
+    ans.m_owned.resize(ans.m_offsets.back());
+    for (std::size_t i = 0; i < ans.m_patterns.size(); ++i) {
+        PatternSearch(size, ans.m_patterns[i], threads, ans.m_owned.data() + ans.m_offsets[i]).run();
+    }
+    ans.m_data = ans.m_owned.data();
+    return ans;
+}
+
+/*
+ * File layout (native byte order):
+ *   magic[8], u32 size, u32 table count, for every table u32 tile count and u32 tiles,
+ *   zero padding up to a multiple of 64 bytes, then one byte per entry for all tables.
+ */
+bool PatternDatabase::save(const std::string & path) const
+{
+    std::ofstream out(path, std::ios::binary);
+    if (!out) {
+        return false;
+    }
+    out.write(file_magic, sizeof(file_magic));
+    write_value(out, std::uint32_t(m_size));
+    write_value(out, std::uint32_t(m_patterns.size()));
+    std::uint64_t header = sizeof(file_magic) + 2 * sizeof(std::uint32_t);
+    for (const auto & pattern : m_patterns) {
+        write_value(out, std::uint32_t(pattern.size()));
+        for (unsigned tile : pattern) {
+            write_value(out, std::uint32_t(tile));
+        }
+        header += (pattern.size() + 1) * sizeof(std::uint32_t);
+    }
+    for (; header % data_alignment != 0; ++header) {
+        out.put('\0');
+    }
+    out.write(reinterpret_cast<const char *>(m_data), m_offsets.back());
+    return static_cast<bool>(out);
+}
+
+PatternDatabase PatternDatabase::load(const std::string & path)
+{
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("can't open pattern database " + path);
+    }
+    struct stat info{};
+    void * mapping = MAP_FAILED;
+    if (::fstat(fd, &info) == 0 && info.st_size > 0) {
+        mapping = ::mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        throw std::runtime_error("can't map pattern database " + path);
+    }
+
+    PatternDatabase ans;
+    ans.m_mapping = mapping;
+    ans.m_mapping_size = info.st_size;
+    const auto * data = static_cast<const std::uint8_t *>(mapping);
+    std::size_t offset = sizeof(file_magic);
+    std::uint32_t size = 0, count = 0;
+    bool ok = ans.m_mapping_size >= offset && std::memcmp(data, file_magic, sizeof(file_magic)) == 0
+            && read_value(data, ans.m_mapping_size, offset, size)
+            && read_value(data, ans.m_mapping_size, offset, count);
+    // Every count is checked against the board and the file before anything is allocated for it
+    const auto fits = [&](const std::uint32_t values) {
+        return values <= (ans.m_mapping_size - offset) / sizeof(std::uint32_t);
+    };
+    ok = ok && size >= 2 && size <= max_board_size && count < size * size && fits(count);
+    std::vector<Pattern> patterns(ok ? count : 0);
+    for (auto & pattern : patterns) {
+        std::uint32_t tiles = 0;
+        ok = ok && read_value(data, ans.m_mapping_size, offset, tiles) && tiles < size * size && fits(tiles);
+        pattern.resize(ok ? tiles : 0);
+        for (auto & tile : pattern) {
+            std::uint32_t value = 0;
+            read_value(data, ans.m_mapping_size, offset, value);
+            tile = value;
+        }
+    }
+    offset = (offset + data_alignment - 1) / data_alignment * data_alignment;
+    std::uint64_t length = 0;
+    for (const auto & pattern : patterns) {
+        const std::uint64_t entries = table_entries(size * size, pattern.size());
+        ok = ok && offset <= ans.m_mapping_size && entries <= ans.m_mapping_size - offset - length;
+        length += ok ? entries : 0;
+    }
+    if (ok) {
+        try {
+            ans.set_patterns(size, std::move(patterns));
+        } catch (const std::invalid_argument &) {
+            ok = false;
+        }
+    }
+    if (!ok) {
+        throw std::runtime_error("malformed pattern database " + path);
+    }
+    ans.m_data = data + offset;
+    return ans;
+}
+
+PatternDatabase::PatternDatabase(PatternDatabase && other) noexcept
+    : m_size(other.m_size)
+    , m_patterns(std::move(other.m_patterns))
+    , m_offsets(std::move(other.m_offsets))
+    , m_owned(std::move(other.m_owned))
+    , m_mapping(std::exchange(other.m_mapping, nullptr))
+    , m_mapping_size(std::exchange(other.m_mapping_size, 0))
+    , m_data(std::exchange(other.m_data, nullptr))
+{}
+
+PatternDatabase & PatternDatabase::operator = (PatternDatabase && other) noexcept
+{
+    if (this != &other) {
+        release();
+        m_size = other.m_size;
+        m_patterns = std::move(other.m_patterns);
+        m_offsets = std::move(other.m_offsets);
+        m_owned = std::move(other.m_owned);
+        m_mapping = std::exchange(other.m_mapping, nullptr);
+        m_mapping_size = std::exchange(other.m_mapping_size, 0);
+        m_data = std::exchange(other.m_data, nullptr);
+    }
+    return *this;
+}
+
+PatternDatabase::~PatternDatabase()
+{
+    release();
+}
+
+void PatternDatabase::release()
+{
+    if (m_mapping != nullptr) {
+        ::munmap(m_mapping, m_mapping_size);
+        m_mapping = nullptr;
+        m_mapping_size = 0;
+    }
+}
+
+unsigned PatternDatabase::evaluate(const Cell * cells) const
+{
+    std::array<Cell, max_board_size * max_board_size> where{};
+    for (unsigned i = 0; i < m_size * m_size; ++i) {
+        where[cells[i]] = i;
+    }
+    unsigned ans = 0;
+    std::array<Cell, max_board_size * max_board_size> position{};
+    for (std::size_t t = 0; t < m_patterns.size(); ++t) {
+        const auto & pattern = m_patterns[t];
+        for (std::size_t i = 0; i < pattern.size(); ++i) {
+            position[i] = where[pattern[i]];
+        }
+        ans += m_data[m_offsets[t] + rank(position.data(), pattern.size(), m_size * m_size)];
+    }
+    return ans;
+}
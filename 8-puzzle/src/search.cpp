@@ -0,0 +1,257 @@
+#include "search.h"
+#include <algorithm>
+#include <cstring>
+#include <new>
+
+bool apply_move(const unsigned blank, const Move move, const unsigned size, unsigned & target)
+{
+    switch (move) {
+        case Up:
+            target = blank - size;
+            return blank >= size;
+        case Down:
+            target = blank + size;
+            return blank + size < size * size;
+        case Left:
+            target = blank - 1;
+            return blank % size != 0;
+        case Right:
+            target = blank + 1;
+            return blank % size != size - 1;
+        default:
+            return false;
+    }
+}
+
+std::vector<Cell> pack_board(const Board & board)
+{
+    std::vector<Cell> cells;
+    cells.reserve(board.size() * board.size());
+    for (std::size_t i = 0; i < board.size(); ++i) {
+        for (std::size_t j = 0; j < board.size(); ++j) {
+            cells.push_back(board[i][j]);
+        }
+    }
+    return cells;
+}
+
+std::vector<Cell> goal_cells(const unsigned size)
+{
+    std::vector<Cell> cells(size * size);
+    for (unsigned i = 0; i + 1 < size * size; ++i) {
+        cells[i] = i + 1;
+    }
+    return cells;
+}
+
+std::uint64_t hash_cells(const Cell * cells, const unsigned count)
+{
+    const std::uint64_t multiplier = 0x9E3779B97F4A7C15ull;
+    std::uint64_t hash = count;
+    unsigned i = 0;
+    for (; i + 8 <= count; i += 8) {
+        std::uint64_t word;
+        std::memcpy(&word, cells + i, sizeof(word));
+        hash = (hash ^ word) * multiplier;
+        hash ^= hash >> 29;
+    }
+    for (; i < count; ++i) {
+        hash = (hash ^ cells[i]) * multiplier;
+    }
+    hash ^= hash >> 32;
+    return hash * multiplier;
+}
+
+StateTable::StateTable(const unsigned size)
+{
+    reset(size);
+}
+
+void StateTable::reset(const unsigned size)
+{
+    m_count = size * size;
+    m_record = (sizeof(Header) + m_count + alignof(Header) - 1) / alignof(Header) * alignof(Header);
+    m_size = 0;
+    m_arena.reset();
+    m_chunks.clear();
+    if (m_slots.empty()) {
+        m_slots.resize(1 << 10);
+    }
+    std::fill(m_slots.begin(), m_slots.end(), 0);
+}
+
+bool StateTable::matches(const std::uint32_t index, const Cell * cells, const std::uint64_t hash) const
+{
+    return header(index).hash == hash && std::memcmp(this->cells(index), cells, m_count) == 0;
+}
+
+std::uint32_t StateTable::find(const Cell * cells, const std::uint64_t hash) const
+{
+    const std::size_t mask = m_slots.size() - 1;
+    for (std::size_t slot = hash & mask; m_slots[slot] != 0; slot = (slot + 1) & mask) {
+        if (matches(m_slots[slot] - 1, cells, hash)) {
+            return m_slots[slot] - 1;
+        }
+    }
+    return SearchNode::no_parent;
+}
+
+std::pair<std::uint32_t, bool> StateTable::insert(const Cell * cells, const std::uint64_t hash)
+{
+    if (2 * (m_size + 1) > m_slots.size()) {
+        grow();
+    }
+    const std::size_t mask = m_slots.size() - 1;
+    std::size_t slot = hash & mask;
+    for (; m_slots[slot] != 0; slot = (slot + 1) & mask) {
+        if (matches(m_slots[slot] - 1, cells, hash)) {
+            return {m_slots[slot] - 1, false};
+        }
+    }
+    const std::uint32_t index = m_size++;
+    if ((index >> chunk_bits) == m_chunks.size()) {
+        m_chunks.push_back(static_cast<std::byte *>(m_arena.allocate(m_record << chunk_bits, alignof(Header))));
+    }
+    m_slots[slot] = index + 1;
+    std::byte * place = record(index);
+    new (place) Header{{SearchNode::no_parent, 0, 0, 0, NoMove, false}, hash};
+    std::memcpy(place + sizeof(Header), cells, m_count);
+    return {index, true};
+}
+
+void StateTable::grow()
+{
+    m_slots.assign(m_slots.size() * 2, 0);
+    const std::size_t mask = m_slots.size() - 1;
+    for (std::uint32_t index = 0; index < m_size; ++index) {
+        std::size_t slot = header(index).hash & mask;
+        while (m_slots[slot] != 0) {
+            slot = (slot + 1) & mask;
+        }
+        m_slots[slot] = index + 1;
+    }
+}
+
+SearchStats & SearchStats::operator += (const SearchStats & other)
+{
+    generated += other.generated;
+    expanded += other.expanded;
+    duplicates += other.duplicates;
+    peak_open += other.peak_open;
+    peak_memory += other.peak_memory;
+    heuristic_seconds += other.heuristic_seconds;
+    expansion_seconds += other.expansion_seconds;
+    seconds = std::max(seconds, other.seconds);
+    return *this;
+}
+
+void SearchContext::reset(const unsigned size)
+{
+    table.reset(size);
+    open.clear();
+    stats = SearchStats();
+    scratch.resize(size * size);
+    goal.resize(size * size);
+    for (unsigned i = 0; i < size * size; ++i) {
+        goal[i] = (i + 1) % (size * size);
+    }
+}
+
+unsigned SearchContext::evaluate(const HeuristicEvaluator & heuristic, const Cell * cells)
+{
+    if (!timing) {
+        return heuristic(cells);
+    }
+    const auto started = std::chrono::steady_clock::now();
+    const unsigned ans = heuristic(cells);
+    stats.heuristic_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    return ans;
+}
+
+void SearchContext::finish(const std::chrono::steady_clock::time_point started)
+{
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    if (timing) {
+        stats.expansion_seconds = stats.seconds - stats.heuristic_seconds;
+    }
+    stats.peak_memory = table.memory() + stats.peak_open * sizeof(OpenEntry);
+}
+
+std::uint32_t astar(const std::vector<Cell> & start, const unsigned size, const HeuristicEvaluator & heuristic, SearchContext & context, const double weight)
+{
+    const std::uint32_t w = scale_weight(weight);
+    const auto started = std::chrono::steady_clock::now();
+    const unsigned count = size * size;
+    context.reset(size);
+    StateTable & table = context.table;
+    auto & open = context.open;
+    auto & cells = context.scratch;
+    const auto & goal = context.goal;
+    auto & stats = context.stats;
+
+    const std::uint32_t root = table.insert(start.data(), hash_cells(start.data(), count)).first;
+    table.node(root).h = context.evaluate(heuristic, start.data());
+    table.node(root).blank = std::find(start.begin(), start.end(), 0) - start.begin();
+    open.push_back({w * table.node(root).h, 0, root});
+    stats.peak_open = 1;
+
+    std::uint32_t found = SearchNode::no_parent;
+    while (!open.empty()) {
+        std::pop_heap(open.begin(), open.end(), OpenOrder());
+        const OpenEntry top = open.back();
+        open.pop_back();
+        SearchNode & current = table.node(top.node);
+        if (current.closed || current.g != top.g) {
+            continue;
+        }
+        std::copy(table.cells(top.node), table.cells(top.node) + count, cells.begin());
+        if (cells == goal) {
+            found = top.node;
+            break;
+        }
+        current.closed = true;
+        ++stats.expanded;
+
+        const unsigned blank = current.blank;
+        const Move arrived = current.move;
+        const std::uint32_t g = current.g + 1;
+        for (Move move : {Up, Down, Left, Right}) {
+            unsigned target;
+            if ((arrived != NoMove && move == opposite(arrived)) || !apply_move(blank, move, size, target)) {
+                continue;
+            }
+            ++stats.generated;
+            std::swap(cells[blank], cells[target]);
+            const auto [index, inserted] = table.insert(cells.data(), hash_cells(cells.data(), count));
+            SearchNode & child = table.node(index);
+            if (inserted) {
+                child.h = context.evaluate(heuristic, cells.data());
+                child.blank = target;
+            }
+            if (inserted || g < child.g) {
+                child.parent = top.node;
+                child.g = g;
+                child.move = move;
+                child.closed = false;
+                open.push_back({g * weight_scale + w * child.h, g, index});
+                std::push_heap(open.begin(), open.end(), OpenOrder());
+            } else {
+                ++stats.duplicates;
+            }
+            std::swap(cells[blank], cells[target]);
+        }
+        stats.peak_open = std::max(stats.peak_open, open.size());
+    }
+    context.finish(started);
+    return found;
+}
+
+std::vector<Move> trace_moves(const StateTable & table, std::uint32_t index)
+{
+    std::vector<Move> path;
+    for (; index != SearchNode::no_parent && table.node(index).move != NoMove; index = table.node(index).parent) {
+        path.push_back(table.node(index).move);
+    }
+    std::reverse(path.begin(), path.end());
+    return path;
+}
@@ -1,68 +1,180 @@
 #include "solver.h"
-#include <set>
+#include "search.h"
+#include <algorithm>
 #include <map>
+#include <set>
+#include <tuple>
 #include <vector>
-#include <algorithm>
 
-bool check_cell(unsigned x, unsigned y, size_t size) {
-    return (x < size && y < size);
-}
+namespace {
 
-Solver::Solver(const Board &board) {
-    Board cur_table = board;
-    if (board.is_goal()) {
-        m_moves.push_back(cur_table);
-    } else if (cur_table.is_solvable()) {
-        std::map<Board, Board> parent;
-        std::set<std::pair<unsigned, Board>> priority;
-        std::map<Board, unsigned> cost;
-        cost[cur_table] = 0;
-        while (!cur_table.is_goal()) {
-            unsigned x = 0, y = 0;
-            for (size_t i = 0; i < cur_table.size(); ++i) {
-                for (size_t j = 0; j < cur_table.size(); ++j) {
-                    if (cur_table[i][j] == 0) {
-                        x = i;
-                        y = j;
-                    }
-                }
+unsigned find_blank(const Board & board)
+{
+    for (unsigned i = 0; i < board.size(); ++i) {
+        for (unsigned j = 0; j < board.size(); ++j) {
+            if (board[i][j] == 0) {
+                return i * board.size() + j;
             }
+        }
+    }
+    return 0;
+}
 
-            Board prev_table = cur_table;
-            unsigned cur_cost = cost[cur_table] + 1;
-
-            for (auto & i : direction) {
-                unsigned cur_x = x + i.first;
-                unsigned cur_y = y + i.second;
-                if (check_cell(cur_x, cur_y, cur_table.size())) {
-                    cur_table.swap_cells(cur_x, cur_y, x, y);
-                    if (cost.count(cur_table) == 0 || cost[cur_table] > cur_cost) {
-                        parent[cur_table] = prev_table;
-                        cost[cur_table] = cur_cost;
-                        priority.insert({prev_table.hamming() + prev_table.manhattan() + cur_cost, cur_table});
-                    }
-                    cur_table.swap_cells(cur_x, cur_y, x, y);
-                }
+/**
+ * A* over whole boards with the Manhattan distance, used for boards
+ * whose tiles don't fit into a Cell
+ */
+std::vector<Move> board_search(const Board & start)
+{
+    const unsigned size = start.size();
+    // Cost and the move that reached every board
+    std::map<Board, std::pair<unsigned, Move>> reached;
+    // f, -g and the board: lowest f first, deeper boards first among equal f
+    std::set<std::tuple<unsigned, int, Board>> open;
+    reached[start] = {0, NoMove};
+    open.emplace(start.manhattan(), 0, start);
+    Board current;
+    while (!open.empty()) {
+        const auto [f, depth, board] = *open.begin();
+        open.erase(open.begin());
+        const unsigned g = -depth;
+        if (reached[board].first != g) {
+            continue;
+        }
+        if (board.is_goal()) {
+            current = board;
+            break;
+        }
+        const unsigned blank = find_blank(board);
+        for (Move move : {Up, Down, Left, Right}) {
+            unsigned target;
+            if (!apply_move(blank, move, size, target)) {
+                continue;
+            }
+            Board next = board;
+            next.swap_cells(blank / size, blank % size, target / size, target % size);
+            const auto it = reached.find(next);
+            if (it == reached.end() || it->second.first > g + 1) {
+                reached[next] = {g + 1, move};
+                open.emplace(g + 1 + next.manhattan(), -int(g + 1), next);
             }
-            cur_table = priority.begin()->second;
-            priority.erase(priority.begin());
         }
+    }
+
+    std::vector<Move> path;
+    unsigned blank = find_blank(current);
+    for (Move move = reached[current].second; move != NoMove; move = reached[current].second) {
+        path.push_back(move);
+        unsigned target;
+        apply_move(blank, opposite(move), size, target);
+        current.swap_cells(blank / size, blank % size, target / size, target % size);
+        blank = target;
+    }
+    std::reverse(path.begin(), path.end());
+    return path;
+}
+
+} // namespace
+
+Solver::Solver(const Board & board)
+    : Solver(board, SolverOptions())
+{}
+
+Solver::Solver(const Board & board, const SolverOptions & options)
+{
+    SearchContext context;
+    *this = Solver(board, options, context);
+}
 
-        cur_table = Board::create_goal(cur_table.size());
-        while (cur_table != board) {
-            m_moves.push_back(cur_table);
-            cur_table = parent[cur_table];
+Solver::Solver(const Board & board, const SolverOptions & options, SearchContext & context)
+    : m_start(board)
+{
+    if (board.is_goal()) {
+        m_solved = true;
+        return;
+    }
+    if (!board.is_solvable()) {
+        return;
+    }
+    const unsigned size = board.size();
+    std::vector<Move> path;
+    if (size > max_board_size) {
+        path = board_search(board);
+    } else {
+        const HeuristicEvaluator heuristic(options.heuristic, size, options.database);
+        const std::vector<Cell> start = pack_board(board);
+        context.timing = options.timing;
+        if (options.algorithm == Algorithm::Anytime) {
+            const auto deadline = options.deadline.count() > 0
+                    ? std::chrono::steady_clock::now() + options.deadline
+                    : std::chrono::steady_clock::time_point::max();
+            path = anytime_astar(start, size, heuristic, options.weight, deadline, m_bound, context);
+        } else if (options.algorithm == Algorithm::Bidirectional) {
+            const HeuristicEvaluator backward(options.heuristic, size, options.database, start);
+            path = bidirectional_search(start, size, heuristic, backward, context);
+        } else if (options.threads > 1) {
+            path = parallel_astar(start, size, heuristic, options.threads, context);
+        } else {
+            path = trace_moves(context.table, astar(start, size, heuristic, context, options.weight));
+            m_bound = double(scale_weight(options.weight)) / weight_scale;
         }
-        m_moves.push_back(cur_table);
-        std::reverse(m_moves.begin(), m_moves.end());
+    }
+
+    m_stats = context.stats;
+    m_solved = true;
+    m_blank = find_blank(board);
+    m_length = path.size();
+    m_moves.assign((m_length + 3) / 4, 0);
+    for (std::size_t i = 0; i < m_length; ++i) {
+        m_moves[i / 4] |= path[i] << (i % 4 * 2);
     }
 }
 
 std::size_t Solver::moves() const {
-    if (m_moves.empty()) {
-        return 0;
-    } else {
-        return m_moves.size() - 1;
+    return m_length;
+}
+
+unsigned Solver::move(const std::size_t step) const
+{
+    return (m_moves[step / 4] >> (step % 4 * 2)) & 3;
+}
+
+Solver::iterator Solver::begin() const
+{
+    return iterator(this, 0);
+}
+
+Solver::iterator Solver::end() const
+{
+    return iterator(nullptr, m_solved ? m_length + 1 : 0);
+}
+
+Solver::iterator::iterator(const Solver * solver, const std::size_t step)
+    : m_solver(solver)
+    , m_step(step)
+{
+    if (solver != nullptr && solver->m_solved) {
+        m_blank = solver->m_blank;
+        m_board = solver->m_start;
     }
 }
 
+Solver::iterator & Solver::iterator::operator ++ ()
+{
+    if (m_step < m_solver->m_length) {
+        const unsigned size = m_board.size();
+        unsigned target;
+        apply_move(m_blank, static_cast<Move>(m_solver->move(m_step)), size, target);
+        m_board.swap_cells(m_blank / size, m_blank % size, target / size, target % size);
+        m_blank = target;
+    }
+    ++m_step;
+    return *this;
+}
+
+Solver::iterator Solver::iterator::operator ++ (int)
+{
+    iterator ans = *this;
+    ++*this;
+    return ans;
+}
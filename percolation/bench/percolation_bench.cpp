@@ -0,0 +1,213 @@
+#include "NewmanZiff.h"
+#include "Percolation.h"
+#include "PercolationStats.h"
+#include "Random.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <math.h>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+/*
+ * Latency of Percolation operations on grids from 16^2 up, trials per
+ * second of PercolationStats for 1..N threads, the same trials as one
+ * Newman-Ziff sweep each and the peak memory, printed as one JSON object.
+ * Both see the same random streams, so the exit code is 2 when their
+ * thresholds differ.
+ */
+
+namespace {
+
+struct Options
+{
+    size_t max_size = 16384;
+    size_t trials = 2000;
+    size_t stats_size = 128;
+    size_t threads = std::max(1u, std::thread::hardware_concurrency());
+    std::uint64_t seed = 1;
+    std::string output_path;
+};
+
+// Operations timed per grid, opening stops earlier when the grid percolates
+const size_t max_operations = 1 << 24;
+
+// Newman-Ziff sums the thresholds in another order than PercolationStats
+const double rounding = 1e-9;
+
+void usage()
+{
+    std::cerr << "Usage: percolation_bench [--max-size N] [--trials T] [--stats-size N] [--threads N] [--seed S] [--output FILE]\n"
+              << "Grids are 16, 64, 256, ... up to --max-size; PercolationStats runs T (at least 1) trials on an\n"
+              << "--stats-size (at least 1) grid with 1, 2, 4, ... up to --threads threads, NewmanZiff runs them\n"
+              << "on --threads threads and must give the same mean and standard deviation." << std::endl;
+}
+
+size_t peak_memory()
+{
+#if defined(__unix__) || defined(__APPLE__)
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#if defined(__APPLE__)
+    return usage.ru_maxrss;
+#else
+    return usage.ru_maxrss * size_t(1024);
+#endif
+#else
+    return 0;
+#endif
+}
+
+double seconds_since(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void grid_bench(std::ostream & out, size_t size, std::uint64_t seed)
+{
+    Random random(seed, size);
+    auto start = std::chrono::steady_clock::now();
+    Percolation percolation(size);
+    const double construct = seconds_since(start);
+
+    // Random cells, so some calls find the cell open already
+    size_t opens = 0;
+    start = std::chrono::steady_clock::now();
+    while (opens < max_operations && !percolation.has_percolation()) {
+        percolation.open(random.below(size), random.below(size));
+        ++opens;
+    }
+    const double open = seconds_since(start);
+
+    const size_t queries = std::min(max_operations, std::max<size_t>(opens, 1 << 20));
+    size_t full = 0;
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < queries; ++i) {
+        full += percolation.is_full(random.below(size), random.below(size));
+    }
+    const double is_full = seconds_since(start);
+
+    size_t percolates = 0;
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < queries; ++i) {
+        percolates += percolation.has_percolation();
+        // Keeps the call inside the loop
+        std::atomic_signal_fence(std::memory_order_seq_cst);
+    }
+    const double has_percolation = seconds_since(start);
+
+    out << "    {\"size\": " << size
+        << ", \"construct_seconds\": " << construct
+        << ", \"opens\": " << opens
+        << ", \"open_call_ns\": " << open / opens * 1e9
+        << ", \"open_cells\": " << percolation.get_numbet_of_open_cells()
+        << ", \"percolates\": " << (percolation.has_percolation() ? "true" : "false")
+        << ", \"queries\": " << queries
+        << ", \"is_full_ns\": " << is_full / queries * 1e9
+        << ", \"full_hits\": " << full
+        << ", \"has_percolation_ns\": " << has_percolation / queries * 1e9
+        << ", \"peak_memory\": " << peak_memory()
+        << "}";
+    (void)percolates;
+}
+
+} // namespace
+
+int main(int argc, char * argv[])
+{
+    Options options;
+    try {
+        for (int i = 1; i < argc; ++i) {
+            const std::string arg = argv[i];
+            if (arg == "--max-size" && i + 1 < argc) {
+                options.max_size = std::stoul(argv[++i]);
+            } else if (arg == "--trials" && i + 1 < argc && std::stoul(argv[i + 1]) > 0) {
+                options.trials = std::stoul(argv[++i]);
+            } else if (arg == "--stats-size" && i + 1 < argc && std::stoul(argv[i + 1]) > 0) {
+                options.stats_size = std::stoul(argv[++i]);
+            } else if (arg == "--threads" && i + 1 < argc) {
+                options.threads = std::max(1ul, std::stoul(argv[++i]));
+            } else if (arg == "--seed" && i + 1 < argc) {
+                options.seed = std::stoull(argv[++i]);
+            } else if (arg == "--output" && i + 1 < argc) {
+                options.output_path = argv[++i];
+            } else {
+                usage();
+                return 1;
+            }
+        }
+    } catch (const std::logic_error &) {
+        usage();
+        return 1;
+    }
+
+    std::ofstream file;
+    if (!options.output_path.empty()) {
+        file.open(options.output_path);
+        if (!file) {
+            std::cerr << "Can't write " << options.output_path << std::endl;
+            return 1;
+        }
+    }
+    std::ostream & out = options.output_path.empty() ? std::cout : file;
+
+    out << "{\n  \"seed\": " << options.seed << ",\n  \"grids\": [\n";
+    for (size_t size = 16; size <= options.max_size; size *= 4) {
+        grid_bench(out, size, options.seed);
+        out << (size * 4 <= options.max_size ? ",\n" : "\n");
+        out.flush();
+    }
+
+    out << "  ],\n  \"stats\": {\"size\": " << options.stats_size << ", \"trials\": " << options.trials << ", \"runs\": [\n";
+    double single = 0;
+    std::vector<size_t> counts;
+    for (size_t threads = 1; threads < options.threads; threads *= 2) {
+        counts.push_back(threads);
+    }
+    counts.push_back(options.threads);
+    double mean = 0, deviation = 0;
+    for (size_t i = 0; i < counts.size(); ++i) {
+        const auto start = std::chrono::steady_clock::now();
+        const PercolationStats stats(options.stats_size, options.trials, counts[i], options.seed, false);
+        const double seconds = seconds_since(start);
+        mean = stats.get_mean();
+        deviation = stats.get_standard_deviation();
+        if (i == 0) {
+            single = seconds;
+        }
+        out << "    {\"threads\": " << counts[i]
+            << ", \"seconds\": " << seconds
+            << ", \"trials_per_second\": " << options.trials / seconds
+            << ", \"speedup\": " << single / seconds
+            << ", \"mean\": " << stats.get_mean()
+            << "}" << (i + 1 < counts.size() ? ",\n" : "\n");
+        out.flush();
+    }
+    out << "  ]},\n";
+
+    const auto start = std::chrono::steady_clock::now();
+    const NewmanZiff sweep(options.stats_size, options.trials, options.threads, options.seed);
+    const double seconds = seconds_since(start);
+    const bool same = fabs(sweep.get_mean() - mean) <= rounding
+            && (options.trials < 2 || fabs(sweep.get_standard_deviation() - deviation) <= rounding);
+    out << "  \"newman_ziff\": {\"size\": " << options.stats_size
+        << ", \"trials\": " << options.trials
+        << ", \"threads\": " << options.threads
+        << ", \"seconds\": " << seconds
+        << ", \"trials_per_second\": " << options.trials / seconds
+        << ", \"mean\": " << sweep.get_mean()
+        << ", \"stddev\": " << sweep.get_standard_deviation()
+        << ", \"same_as_stats\": " << (same ? "true" : "false")
+        << "},\n  \"peak_memory\": " << peak_memory() << "\n}" << std::endl;
+    return same ? 0 : 2;
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <stdio.h>
+#include <vector>
+
+/**
+ * Fixed number of bits packed 64 to a word, e.g. the open sites of a padded grid
+ */
+struct Bitset
+{
+private:
+
+    std::vector<std::uint64_t> words;
+
+public:
+
+    Bitset(size_t count = 0) : words((count + 63) / 64, 0)
+    {
+    }
+
+    bool test(size_t bit) const
+    { return (words[bit >> 6] >> (bit & 63)) & 1; }
+
+    void set(size_t bit)
+    { words[bit >> 6] |= std::uint64_t(1) << (bit & 63); }
+
+    /**
+     * Clears all bits, keeping the allocated memory
+     */
+    void reset()
+    { std::fill(words.begin(), words.end(), 0); }
+};
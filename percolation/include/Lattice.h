@@ -0,0 +1,58 @@
+#pragma once
+
+#include <array>
+#include <stdio.h>
+
+/*
+ * Neighbourhoods of the lattices, as coordinate offsets on a square or a
+ * cubic grid. Offsets k and size - 1 - k are opposite, so the first half
+ * names every bond of a site exactly once. Axis 0 runs from top to bottom.
+ */
+
+template <size_t Dimensions, size_t Neighbours>
+using LatticeOffsets = std::array<std::array<int, Dimensions>, Neighbours>;
+
+/**
+ * Square lattice, 4 neighbours
+ */
+struct Square
+{
+    static constexpr size_t dimensions = 2;
+    static constexpr LatticeOffsets<2, 4> offsets = {{
+            {{-1, 0}}, {{0, -1}}, {{0, 1}}, {{1, 0}},
+    }};
+};
+
+/**
+ * Square lattice with diagonal neighbours, 8 neighbours
+ */
+struct Moore
+{
+    static constexpr size_t dimensions = 2;
+    static constexpr LatticeOffsets<2, 8> offsets = {{
+            {{-1, -1}}, {{-1, 0}}, {{-1, 1}}, {{0, -1}},
+            {{0, 1}}, {{1, -1}}, {{1, 0}}, {{1, 1}},
+    }};
+};
+
+/**
+ * Triangular lattice drawn on a square grid with one diagonal, 6 neighbours
+ */
+struct Triangular
+{
+    static constexpr size_t dimensions = 2;
+    static constexpr LatticeOffsets<2, 6> offsets = {{
+            {{-1, 0}}, {{-1, 1}}, {{0, -1}}, {{0, 1}}, {{1, -1}}, {{1, 0}},
+    }};
+};
+
+/**
+ * Simple cubic lattice, 6 neighbours
+ */
+struct Cubic
+{
+    static constexpr size_t dimensions = 3;
+    static constexpr LatticeOffsets<3, 6> offsets = {{
+            {{-1, 0, 0}}, {{0, -1, 0}}, {{0, 0, -1}}, {{0, 0, 1}}, {{0, 1, 0}}, {{1, 0, 0}},
+    }};
+};
@@ -0,0 +1,452 @@
+#pragma once
+
+#include "Bitset.h"
+#include "Lattice.h"
+#include "Random.h"
+#include "TrialBatch.h"
+#include "UnionFind.h"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <numeric>
+#include <stdexcept>
+#include <stdio.h>
+#include <utility>
+#include <vector>
+
+/**
+ * Sites of a dimension^D grid of the lattice, stored with one padding layer
+ * on every side so that every neighbour of a site is a valid index
+ */
+template <typename Lattice>
+struct LatticeGrid
+{
+    static constexpr size_t dimensions = Lattice::dimensions;
+    static constexpr size_t neighbours = Lattice::offsets.size();
+
+    // Position of a site, axis 0 first
+    using Coordinates = std::array<size_t, dimensions>;
+
+    // Bits of a cluster root: some site of the cluster is in the top or the bottom layer
+    enum Side : std::uint8_t {
+        TOP = 1, BOTTOM = 2
+    };
+
+    size_t dimension;
+
+    // Padded index step along every axis
+    std::array<size_t, dimensions> strides;
+
+    // Padded index offsets of the neighbours
+    std::array<std::ptrdiff_t, neighbours> steps;
+
+    size_t sites;
+
+    size_t padded_sites;
+
+    LatticeGrid(size_t dimension) : dimension(dimension), sites(1), padded_sites(1)
+    {
+        for (size_t axis = dimensions; axis-- > 0; ) {
+            strides[axis] = padded_sites;
+            padded_sites *= dimension + 2;
+            sites *= dimension;
+        }
+        for (size_t k = 0; k < neighbours; ++k) {
+            steps[k] = 0;
+            for (size_t axis = 0; axis < dimensions; ++axis) {
+                steps[k] += Lattice::offsets[k][axis] * std::ptrdiff_t(strides[axis]);
+            }
+        }
+    }
+
+    /**
+     * Padded index of the site, sites are numbered row-major from 0
+     */
+    size_t padded(size_t site) const
+    {
+        size_t ans = 0;
+        for (size_t axis = dimensions; axis-- > 0; ) {
+            ans += (site % dimension + 1) * strides[axis];
+            site /= dimension;
+        }
+        return ans;
+    }
+
+    /**
+     * Padded index of the site at the coordinates, without the divisions of padded(site)
+     */
+    size_t padded(const Coordinates & at) const
+    {
+        size_t ans = 0;
+        for (size_t axis = 0; axis < dimensions; ++axis) {
+            ans += (at[axis] + 1) * strides[axis];
+        }
+        return ans;
+    }
+
+    bool inside(const Coordinates & at) const
+    {
+        return std::all_of(at.begin(), at.end(), [this](size_t coordinate) { return coordinate < dimension; });
+    }
+
+    std::uint8_t layer_sides(size_t layer) const
+    { return (layer == 0 ? TOP : 0) | (layer + 1 == dimension ? BOTTOM : 0); }
+
+    std::uint8_t site_sides(size_t site) const
+    { return layer_sides(site / (sites / dimension)); }
+};
+
+/**
+ * Site percolation on the lattice: sites open one by one, open neighbours are connected.
+ * Open sites are bits of the padded grid, so the neighbours of every site are in range
+ */
+template <typename Lattice>
+struct SitePercolation
+{
+private:
+
+    using Grid = LatticeGrid<Lattice>;
+
+    Grid grid;
+
+    // One bit per padded site, the padding stays closed
+    Bitset opened;
+
+    // Open sites joined into clusters, elements are padded site indices. The side
+    // bits of every cluster are its tags: unlike a virtual bottom site joined with
+    // the whole bottom layer they don't make bottom sites look full
+    UnionFind clusters;
+
+    size_t open_sites;
+
+    bool percolates;
+
+    /**
+     * Opens the padded site without joining it with the neighbours
+     * @return true if the site was closed
+     */
+    bool mark(size_t cell, std::uint8_t sides)
+    {
+        if (opened.test(cell)) {
+            return false;
+        }
+        opened.set(cell);
+        ++open_sites;
+        clusters.add_tags(cell, sides);
+        return true;
+    }
+
+    /**
+     * Joins the open site with its open neighbours, only with the ones
+     * before it when the grid is labeled in row-major order
+     * @param merged called as merged(lhs, rhs, root) for every two clusters joined
+     */
+    template <typename Merged>
+    void join(size_t cell, bool raster, Merged && merged)
+    {
+        // The site may already be joined by a neighbour opened in the same batch
+        size_t root = clusters.find(cell);
+        for (size_t k = 0; k < (raster ? Grid::neighbours / 2 : Grid::neighbours); ++k) {
+            const size_t neighbour = cell + grid.steps[k];
+            if (!opened.test(neighbour)) {
+                continue;
+            }
+            const size_t other = clusters.find(neighbour);
+            if (other != root) {
+                const size_t joined = clusters.unite(root, other);
+                merged(root, other, joined);
+                root = joined;
+            }
+        }
+        percolates = percolates || clusters.tags(root) == (Grid::TOP | Grid::BOTTOM);
+    }
+
+public:
+
+    using Coordinates = typename Grid::Coordinates;
+
+    SitePercolation(size_t dimension)
+        : grid(dimension)
+        , opened(grid.padded_sites)
+        , clusters(grid.padded_sites)
+        , open_sites(0)
+        , percolates(false)
+    {
+    }
+
+    /**
+     * Construct the grid from a static map, clusters are labeled
+     * in one row-major pass after all sites are opened
+     * @param bitmap row-major sites, nonzero is open
+     * @throw std::invalid_argument if the bitmap doesn't have dimension^D sites
+     */
+    SitePercolation(size_t dimension, const std::vector<std::uint8_t> & bitmap)
+        : SitePercolation(dimension)
+    {
+        if (bitmap.size() != grid.sites) {
+            throw std::invalid_argument("bitmap size doesn't match the dimension");
+        }
+        for (size_t site = 0; site < grid.sites; ++site) {
+            if (bitmap[site]) {
+                mark(grid.padded(site), grid.site_sides(site));
+            }
+        }
+        for (size_t site = 0; site < grid.sites; ++site) {
+            if (bitmap[site]) {
+                join(grid.padded(site), true, [](size_t, size_t, size_t) {});
+            }
+        }
+    }
+
+    size_t dimension() const
+    { return grid.dimension; }
+
+    /**
+     * Returns number of sites, the units a trial opens
+     */
+    size_t units() const
+    { return grid.sites; }
+
+    size_t valid_units() const
+    { return grid.sites; }
+
+    void reset()
+    {
+        opened.reset();
+        clusters.reset();
+        open_sites = 0;
+        percolates = false;
+    }
+
+    /**
+     * Opens the site, sites are numbered row-major from 0
+     * @param merged called as merged(lhs, rhs, root) with the cluster ids of every two clusters joined
+     * @return true if the site was closed
+     */
+    template <typename Merged>
+    bool open(size_t site, Merged && merged)
+    {
+        const size_t cell = grid.padded(site);
+        if (!mark(cell, grid.site_sides(site))) {
+            return false;
+        }
+        join(cell, false, merged);
+        return true;
+    }
+
+    bool open(size_t site)
+    { return open(site, [](size_t, size_t, size_t) {}); }
+
+    bool open(const Coordinates & at)
+    {
+        const size_t cell = grid.padded(at);
+        if (!mark(cell, grid.layer_sides(at[0]))) {
+            return false;
+        }
+        join(cell, false, [](size_t, size_t, size_t) {});
+        return true;
+    }
+
+    /**
+     * Opens all the sites first and then joins the new ones into clusters
+     * @param sites sites to open, already open ones are skipped
+     * @param count number of sites
+     */
+    void open_many(const size_t * sites, size_t count)
+    {
+        std::vector<size_t> added;
+        for (size_t i = 0; i < count; ++i) {
+            const size_t cell = grid.padded(sites[i]);
+            if (mark(cell, grid.site_sides(sites[i]))) {
+                added.push_back(cell);
+            }
+        }
+        // Padded order keeps the union-find accesses close together
+        std::sort(added.begin(), added.end());
+        for (const size_t cell : added) {
+            join(cell, false, [](size_t, size_t, size_t) {});
+        }
+    }
+
+    /**
+     * Returns id of the cluster of the site, below cluster_ids(). A closed site is a cluster of its own
+     */
+    size_t cluster(size_t site) const
+    { return clusters.root(grid.padded(site)); }
+
+    size_t cluster_ids() const
+    { return grid.padded_sites; }
+
+    bool is_open(size_t site) const
+    { return site < grid.sites && opened.test(grid.padded(site)); }
+
+    bool is_open(const Coordinates & at) const
+    { return grid.inside(at) && opened.test(grid.padded(at)); }
+
+    bool is_full(size_t site) const
+    { return is_open(site) && (clusters.tags(clusters.root(grid.padded(site))) & Grid::TOP); }
+
+    bool is_full(const Coordinates & at) const
+    { return is_open(at) && (clusters.tags(clusters.root(grid.padded(at))) & Grid::TOP); }
+
+    size_t get_number_of_open_units() const
+    { return open_sites; }
+
+    bool has_percolation() const
+    { return percolates; }
+};
+
+/**
+ * Bond percolation on the lattice: every site is present, bonds between
+ * neighbouring sites open one by one. Bond site * (neighbours / 2) + k joins
+ * the site with its neighbour k; bonds leading out of the grid never open
+ */
+template <typename Lattice>
+struct BondPercolation
+{
+private:
+
+    using Grid = LatticeGrid<Lattice>;
+
+    static constexpr size_t half = Grid::neighbours / 2;
+
+    Grid grid;
+
+    // One bit per bond slot
+    Bitset opened;
+
+    // Side bits of every cluster are its tags
+    UnionFind clusters;
+
+    size_t open_bonds;
+
+    bool percolates;
+
+    bool inside(size_t site, size_t k) const
+    {
+        for (size_t axis = Grid::dimensions; axis-- > 0; ) {
+            const size_t coordinate = site % grid.dimension + Lattice::offsets[k][axis];
+            if (coordinate >= grid.dimension) {
+                return false;
+            }
+            site /= grid.dimension;
+        }
+        return true;
+    }
+
+public:
+
+    BondPercolation(size_t dimension)
+        : grid(dimension)
+        , opened(grid.sites * half)
+        , clusters(grid.padded_sites)
+    {
+        reset();
+    }
+
+    size_t dimension() const
+    { return grid.dimension; }
+
+    /**
+     * Returns number of bond slots, the units a trial opens, including the ones leading out of the grid
+     */
+    size_t units() const
+    { return grid.sites * half; }
+
+    /**
+     * Returns number of bonds inside the grid
+     */
+    size_t valid_units() const
+    {
+        size_t ans = 0;
+        for (size_t site = 0; site < grid.sites; ++site) {
+            for (size_t k = 0; k < half; ++k) {
+                ans += inside(site, k);
+            }
+        }
+        return ans;
+    }
+
+    void reset()
+    {
+        opened.reset();
+        clusters.reset();
+        open_bonds = 0;
+        percolates = grid.dimension == 1;
+        for (size_t site = 0; site < grid.sites; ++site) {
+            clusters.add_tags(grid.padded(site), grid.site_sides(site));
+        }
+    }
+
+    /**
+     * Opens the bond
+     * @return true if the bond is inside the grid and was closed
+     */
+    bool open(size_t bond)
+    {
+        const size_t site = bond / half, k = bond % half;
+        if (opened.test(bond) || !inside(site, k)) {
+            return false;
+        }
+        opened.set(bond);
+        ++open_bonds;
+        const size_t cell = grid.padded(site);
+        const size_t root = clusters.unite(clusters.find(cell), clusters.find(cell + grid.steps[k]));
+        percolates = percolates || clusters.tags(root) == (Grid::TOP | Grid::BOTTOM);
+        return true;
+    }
+
+    bool is_open(size_t bond) const
+    { return bond < units() && opened.test(bond); }
+
+    /**
+     * Checks if the site is connected to the top layer
+     */
+    bool is_full(size_t site) const
+    { return site < grid.sites && (clusters.tags(clusters.root(grid.padded(site))) & Grid::TOP); }
+
+    size_t get_number_of_open_units() const
+    { return open_bonds; }
+
+    bool has_percolation() const
+    { return percolates; }
+};
+
+/**
+ * Opens units of the grid in the order of a random permutation until it percolates
+ * @param order permutation buffer, reused between trials
+ * @return number of units opened when the grid started to percolate, units leading out of the grid don't count
+ */
+template <typename Grid>
+size_t lattice_trial(Grid & grid, std::vector<std::uint32_t> & order, std::uint64_t seed, std::uint64_t trial)
+{
+    grid.reset();
+    order.resize(grid.units());
+    std::iota(order.begin(), order.end(), 0);
+    Random random(seed, trial);
+    for (size_t i = 0; !grid.has_percolation(); ++i) {
+        std::swap(order[i], order[i + random.below(order.size() - i)]);
+        grid.open(order[i]);
+    }
+    return grid.get_number_of_open_units();
+}
+
+/**
+ * Trials of site or bond percolation on a dimension^D grid of the lattice for PercolationStats,
+ * every thread keeps its grid between trials
+ */
+template <typename Grid>
+TrialFunction lattice_trials(size_t dimension)
+{
+    const double total = double(Grid(dimension).valid_units());
+    return [dimension, total](std::uint64_t seed, std::uint64_t trial) {
+        thread_local std::unique_ptr<Grid> grid;
+        thread_local std::vector<std::uint32_t> order;
+        if (!grid || grid->dimension() != dimension) {
+            grid = std::make_unique<Grid>(dimension);
+        }
+        return lattice_trial(*grid, order, seed, trial) / total;
+    };
+}
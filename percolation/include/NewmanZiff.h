@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstdint>
+#include <stdio.h>
+#include <vector>
+
+/**
+ * Newman-Ziff percolation: every trial opens all cells of the grid in the
+ * order of one random permutation, tracking clusters with a union-find.
+ * A single trial gives the threshold and the observables after every
+ * number of open cells, which are then averaged over the trials
+ */
+struct NewmanZiff
+{
+private:
+
+    size_t cells;
+
+    size_t trials;
+
+    // Trials whose grid started to percolate after exactly n open cells
+    std::vector<std::uint64_t> thresholds;
+
+    // Sum over the trials of the largest cluster size after n open cells
+    std::vector<std::uint64_t> largest;
+
+    double mean;
+    double standard_deviation;
+
+    /**
+     * Averages a value known for every number of open cells over the
+     * binomial number of open cells at probability p
+     */
+    double convolve(const std::vector<double> & values, double p) const;
+
+public:
+
+    size_t size;
+
+    /**
+     * Construct a new Newman Ziff object and run the trials
+     * @param dimension dimension of percolation grid
+     * @param trials amount of experiments
+     * @param threads worker count, 0 means all hardware threads
+     * @param seed seed of the random streams
+     */
+    NewmanZiff(size_t dimension, size_t trials, size_t threads = 0, std::uint64_t seed = 0);
+
+    /**
+     * Returns mean of percolation threshold
+     */
+    double get_mean() const;
+
+    /**
+     * Returns standard deviation of percolation threshold
+     */
+    double get_standard_deviation() const;
+
+    /**
+     * Returns low edge of confidence interval
+     */
+    double get_confidence_low() const;
+
+    /**
+     * Returns high edge of confidence interval
+     */
+    double get_confidence_high() const;
+
+    /**
+     * Returns fraction of trials that percolate with `opened` open cells
+     */
+    double percolation_probability(size_t opened) const;
+
+    /**
+     * Returns mean fraction of cells in the largest cluster with `opened` open cells
+     */
+    double largest_cluster(size_t opened) const;
+
+    /**
+     * Returns probability to percolate when every cell is open with probability p
+     */
+    double percolation_probability_at(double p) const;
+
+    /**
+     * Returns mean fraction of cells in the largest cluster when every cell is open with probability p
+     */
+    double largest_cluster_at(double p) const;
+};
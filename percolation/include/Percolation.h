@@ -1,39 +1,59 @@
 #pragma once
 
+#include "LatticePercolation.h"
+#include <cstdint>
+#include <istream>
 #include <stdio.h>
 #include <vector>
 
+/**
+ * Site percolation on the square lattice addressed by row and column,
+ * the same engine the other lattices use
+ */
 struct Percolation
 {
 private:
 
-    enum Type {
-        CLOSED, OPEN, FULL
-    };
-
-    std::vector<std::vector<Type> > table;
-
-    size_t open_cells;
+    // Cell [row, column] is site row * dimension + column
+    SitePercolation<Square> grid;
 
-    bool check_cell(size_t row, size_t column) const;
+    size_t site(size_t row, size_t column) const
+    { return row * grid.dimension() + column; }
 
-    void dfs(size_t row, size_t column);
+public:
 
-    const std::vector<std::pair<int, int> > direction = {
-            {0, 0},
-            {-1, 0},
-            {0, -1},
-            {1, 0},
-            {0, 1},
+    struct Cell
+    {
+        size_t row;
+        size_t column;
     };
 
-public:
-
     /**
      * Construct a new Percolation object
      * @param dimension dimension of percolation table
      */
     Percolation(size_t dimension);
+
+    /**
+     * Construct a Percolation object from a static grid, clusters are
+     * labeled in one row-major pass after all cells are opened
+     * @param dimension dimension of percolation table
+     * @param bitmap row-major cells, nonzero is open
+     * @throw std::invalid_argument if the bitmap doesn't have dimension^2 cells
+     */
+    Percolation(size_t dimension, const std::vector<std::uint8_t> & bitmap);
+
+    /**
+     * Reads a square plain (P1) or raw (P4) PBM image, black pixels are open cells
+     * @throw std::runtime_error on a malformed or non-square image or a P1 pixel other than 0 or 1
+     */
+    static Percolation from_pbm(std::istream & input);
+
+    /**
+     * Closes all cells, keeping the allocated memory
+     */
+    void reset();
+
     /**
      * Opens the cell[row, column] if it's not opened already
      * @param row row index
@@ -41,6 +61,15 @@ public:
      */
     void open(size_t row, size_t column);
 
+    /**
+     * Opens all the cells first and then joins the new ones into clusters
+     * @param cells cells to open, already open ones are skipped
+     * @param count number of cells
+     */
+    void open_many(const Cell * cells, size_t count);
+
+    void open_many(const std::vector<Cell> & cells);
+
     /**
      * Checks if cell[row, column] is open
      * @param row row index
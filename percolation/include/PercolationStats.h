@@ -1,11 +1,29 @@
 #pragma once
 
+#include "RunningStats.h"
+#include "TrialBatch.h"
+#include <chrono>
+#include <cstdint>
 #include <stdio.h>
 #include <vector>
 struct PercolationStats
 {
+    // Grid dimension, 0 when the trials are given as a function
     size_t size;
     std::vector<double> x;
+
+    // Trial t draws its cells from random stream t of this seed
+    std::uint64_t seed;
+
+    // Mean and variance of all trials, kept even when x is not
+    RunningStats stats;
+
+    // Whether every trial result is appended to x
+    bool store_trials;
+
+    // One experiment, run_trial on a size x size Percolation grid by default
+    TrialFunction trial_function;
+
     /**
      * Construct a new Percolation Stats object
      * @param dimension dimension of percolation grid
@@ -13,6 +31,44 @@ struct PercolationStats
      */
     PercolationStats(size_t dimension, size_t trials);
 
+    /**
+     * Construct a new Percolation Stats object running the trials on a thread pool,
+     * the results depend on the seed only, not on the number of threads
+     * @param dimension dimension of percolation grid
+     * @param trials amount of experiments
+     * @param threads worker count, 0 means all hardware threads
+     * @param seed seed of the random streams
+     * @param store_trials keep every result in x, otherwise memory doesn't grow with trials
+     */
+    PercolationStats(size_t dimension, size_t trials, size_t threads, std::uint64_t seed, bool store_trials = true);
+
+    /**
+     * Construct a new Percolation Stats object for any experiment, e.g. another lattice
+     * @param trial experiment, called from any thread
+     * @param trials amount of experiments
+     * @param threads worker count, 0 means all hardware threads
+     * @param seed seed of the random streams
+     * @param store_trials keep every result in x
+     */
+    PercolationStats(TrialFunction trial, size_t trials, size_t threads, std::uint64_t seed, bool store_trials = true);
+
+    /**
+     * Runs batches of trials in parallel until the 95% confidence interval
+     * is at most `width` wide or the time budget is spent
+     * @param dimension dimension of percolation grid
+     * @param width target of get_confidence_high() - get_confidence_low()
+     * @param budget time limit, zero means no limit
+     * @param threads worker count, 0 means all hardware threads
+     * @param seed seed of the random streams
+     * @param store_trials keep every result in x
+     * @throw std::invalid_argument if width is not positive
+     */
+    static PercolationStats adaptive(size_t dimension, double width, std::chrono::milliseconds budget,
+                                     size_t threads = 0, std::uint64_t seed = 0, bool store_trials = true);
+
+    static PercolationStats adaptive(TrialFunction trial, double width, std::chrono::milliseconds budget,
+                                     size_t threads = 0, std::uint64_t seed = 0, bool store_trials = true);
+
     /**
      * Returns mean of percolation threshold (x¯ from description)
      */
@@ -34,7 +90,37 @@ struct PercolationStats
     double get_confidence_high() const;
 
     /**
-     * Makes all experiments, calculates statistic values
+     * Makes one more experiment, updates statistic values
      */
     void execute();
-};
\ No newline at end of file
+
+    /**
+     * Makes experiment number `trial`
+     * @return fraction of open cells when the grid started to percolate
+     */
+    static double run_trial(size_t dimension, std::uint64_t seed, std::uint64_t trial);
+
+private:
+
+    double mean;
+    double standard_deviation;
+    double confidence_low;
+    double confidence_high;
+
+    /**
+     * Runs trials [first, first + count) on the pool and merges them into stats in trial order.
+     * No chunk is started after the deadline, so fewer trials may be run
+     */
+    void run(size_t first, size_t count, size_t threads,
+             std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max());
+
+    /**
+     * Runs more trials until the confidence interval is at most `width` wide or the budget is spent
+     */
+    void refine(double width, std::chrono::milliseconds budget, size_t threads);
+
+    /**
+     * Recomputes the cached getter values from stats
+     */
+    void update();
+};
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * xoshiro256** generator. Its state is filled by SplitMix64 from the seed
+ * and a stream number, so every (seed, stream) pair is an independent sequence
+ */
+struct Random
+{
+private:
+
+    std::uint64_t state[4];
+
+public:
+
+    using result_type = std::uint64_t;
+
+    /**
+     * Construct the generator of one stream
+     * @param seed common seed of all streams
+     * @param stream stream number, e.g. trial index
+     */
+    Random(std::uint64_t seed, std::uint64_t stream = 0);
+
+    static constexpr result_type min()
+    { return 0; }
+
+    static constexpr result_type max()
+    { return UINT64_MAX; }
+
+    result_type operator()();
+
+    /**
+     * Returns uniform number in [0, bound)
+     */
+    std::uint64_t below(std::uint64_t bound);
+};
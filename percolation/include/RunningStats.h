@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * Mean and variance updated one value at a time (Welford)
+ * and merged from independent parts (Chan et al.)
+ */
+struct RunningStats
+{
+    std::uint64_t count = 0;
+    double mean = 0;
+
+    // Sum of squared deviations from the mean
+    double m2 = 0;
+
+    void add(double value);
+
+    void merge(const RunningStats & other);
+
+    /**
+     * Returns unbiased sample variance
+     */
+    double variance() const;
+};
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdio.h>
+#include <thread>
+#include <vector>
+
+/**
+ * Work-stealing pool: every worker runs tasks from its own queue in order
+ * and takes the newest task of another worker once its queue is empty
+ */
+struct ThreadPool
+{
+private:
+
+    struct Queue
+    {
+        std::mutex mutex;
+        std::deque<std::function<void()> > tasks;
+    };
+
+    std::vector<std::unique_ptr<Queue> > queues;
+
+    std::vector<std::thread> workers;
+
+    // Guards sleeping, waiting and the error
+    std::mutex mutex;
+
+    std::condition_variable ready;
+
+    std::condition_variable done;
+
+    // Tasks sitting in the queues, increased under the mutex
+    std::atomic<size_t> queued;
+
+    // Tasks not finished yet
+    size_t unfinished;
+
+    // Queue of the next task submitted from outside the pool
+    size_t next_queue;
+
+    bool stop;
+
+    std::exception_ptr error;
+
+    bool pop(size_t worker, std::function<void()> & task);
+
+    void work(size_t worker);
+
+public:
+
+    /**
+     * Construct a new pool and start its workers
+     * @param threads worker count, 0 means all hardware threads
+     */
+    ThreadPool(size_t threads = 0);
+
+    ThreadPool(const ThreadPool & other) = delete;
+
+    ThreadPool & operator = (const ThreadPool & other) = delete;
+
+    ~ThreadPool();
+
+    /**
+     * Returns number of workers
+     */
+    size_t size() const;
+
+    /**
+     * Queues the task, queues of the workers are filled in turn
+     */
+    void submit(std::function<void()> task);
+
+    /**
+     * Blocks until all submitted tasks finish, rethrows the first exception thrown by a task
+     */
+    void wait();
+};
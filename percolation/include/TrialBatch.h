@@ -0,0 +1,76 @@
+#pragma once
+
+#include "RunningStats.h"
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <stdio.h>
+
+/**
+ * Runs trial number `trial` of the experiment seeded with `seed`
+ * @return fraction of open sites or bonds when the grid started to percolate
+ */
+using TrialFunction = std::function<double(std::uint64_t seed, std::uint64_t trial)>;
+
+/**
+ * Consecutive trials of one grid size split into chunks. Any thread can run
+ * any chunk, the chunk summaries are merged in trial order so the result
+ * doesn't depend on the scheduling
+ */
+struct TrialBatch
+{
+private:
+
+    TrialFunction trial;
+
+    std::uint64_t seed;
+
+    size_t first;
+
+    size_t count;
+
+    double * results;
+
+    std::mutex mutex;
+
+    // Finished chunks waiting until all earlier ones are merged
+    std::map<size_t, RunningStats> pending;
+
+    size_t merged;
+
+    bool started;
+
+    std::chrono::steady_clock::time_point start_time;
+
+public:
+
+    // Trials summarized together
+    static const size_t chunk_size = 256;
+
+    // Merged summary of the finished chunk prefix
+    RunningStats stats;
+
+    // Wall time from the start of the first chunk to the merge of the last one
+    double seconds;
+
+    /**
+     * Construct a batch of trials [first, first + count)
+     * @param trial experiment, called from any thread
+     * @param seed seed of the random streams
+     * @param results where trial t is stored as results[t - first], may be null
+     */
+    TrialBatch(TrialFunction trial, std::uint64_t seed, size_t first, size_t count, double * results = nullptr);
+
+    /**
+     * Returns number of chunks
+     */
+    size_t chunks() const;
+
+    /**
+     * Runs trials of the chunk and merges every chunk that is ready
+     * @return true if the last chunk got merged by this call
+     */
+    bool run_chunk(size_t chunk);
+};
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstdint>
+#include <stdio.h>
+#include <vector>
+
+/**
+ * Disjoint sets with union by rank and path halving. Every set carries
+ * a few tag bits that are merged with the sets, all in one word per element
+ */
+struct UnionFind
+{
+private:
+
+    // Words from first_root up mark roots, the rest are parent indices
+    static constexpr std::uint32_t first_root = UINT32_MAX - 255;
+
+    // Low bits of a root's mark hold its rank, the high ones its tags
+    static constexpr unsigned rank_bits = 6;
+
+    // Parent of every element, first_root + (rank | tags << rank_bits) for a root
+    std::vector<std::uint32_t> parent;
+
+    bool is_root(size_t element) const
+    { return parent[element] >= first_root; }
+
+    std::uint32_t mark(size_t element) const
+    { return parent[element] - first_root; }
+
+public:
+
+    static constexpr unsigned tag_bits = 2;
+
+    /**
+     * Construct count singleton sets
+     * @param count number of elements, below 2^32 - 256
+     */
+    UnionFind(size_t count = 0);
+
+    /**
+     * Makes every element a singleton without tags again
+     */
+    void reset();
+
+    /**
+     * Finds the representative of the element's set, halving the path to it
+     * @param element element index
+     * @return root index
+     */
+    size_t find(size_t element);
+
+    /**
+     * Finds the representative of the element's set without changing the paths,
+     * so const queries stay safe from several threads at once
+     * @param element element index
+     * @return root index
+     */
+    size_t root(size_t element) const;
+
+    /**
+     * Merges the sets of two roots, the merged set gets the tags of both
+     * @param lhs root index
+     * @param rhs root index
+     * @return root of the merged set
+     */
+    size_t unite(size_t lhs, size_t rhs);
+
+    /**
+     * Returns tag bits of the set
+     * @param root root index
+     */
+    std::uint8_t tags(size_t root) const
+    { return mark(root) >> rank_bits; }
+
+    /**
+     * Adds tag bits to the set
+     * @param root root index
+     * @param tags bits below 2^tag_bits
+     */
+    void add_tags(size_t root, std::uint8_t tags)
+    { parent[root] |= std::uint32_t(tags) << rank_bits; }
+};
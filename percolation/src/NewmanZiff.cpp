@@ -0,0 +1,186 @@
+#include "NewmanZiff.h"
+#include "LatticePercolation.h"
+#include "Random.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <numeric>
+#include <utility>
+#include <math.h>
+
+namespace {
+
+/*
+ * One trial on the square-lattice engine of Percolation,
+ * with the number of sites kept for every cluster.
+ */
+struct Sweep
+{
+    SitePercolation<Square> grid;
+    std::vector<std::uint32_t> cluster_size;
+    std::vector<std::uint32_t> order;
+
+    Sweep(size_t dimension)
+        : grid(dimension)
+        , cluster_size(grid.cluster_ids())
+        , order(dimension * dimension)
+    {
+    }
+
+    /**
+     * Opens every site, adds the largest cluster size after each open site to `largest`
+     * @return number of open sites when the grid started to percolate
+     */
+    size_t run(Random & random, std::vector<std::uint64_t> & largest)
+    {
+        grid.reset();
+        std::iota(order.begin(), order.end(), 0);
+        size_t threshold = 0;
+        std::uint32_t biggest = 0;
+        for (size_t i = 0; i < order.size(); ++i) {
+            std::swap(order[i], order[i + random.below(order.size() - i)]);
+            const size_t site = order[i];
+            cluster_size[grid.cluster(site)] = 1;
+            grid.open(site, [this](size_t lhs, size_t rhs, size_t root) {
+                const std::uint32_t merged_size = cluster_size[lhs] + cluster_size[rhs];
+                cluster_size[root] = merged_size;
+            });
+            biggest = std::max(biggest, cluster_size[grid.cluster(site)]);
+            largest[i + 1] += biggest;
+            if (threshold == 0 && grid.has_percolation()) {
+                threshold = i + 1;
+            }
+        }
+        return threshold;
+    }
+};
+
+// Trials taken by a worker at once
+const size_t chunk_size = 16;
+
+} // namespace
+
+NewmanZiff::NewmanZiff(size_t dimension, size_t trials, size_t threads, std::uint64_t seed)
+    : cells(dimension * dimension)
+    , trials(trials)
+    , thresholds(cells + 1, 0)
+    , largest(cells + 1, 0)
+    , size(dimension)
+{
+    const size_t chunks = (trials + chunk_size - 1) / chunk_size;
+    std::atomic<size_t> next(0);
+    std::mutex mutex;
+    ThreadPool pool(std::min(threads == 0 ? std::thread::hardware_concurrency() : threads, std::max<size_t>(chunks, 1)));
+    for (size_t worker = 0; worker < pool.size(); ++worker) {
+        // Sums are integers, so adding them up in any order gives the same result
+        pool.submit([&] {
+            Sweep sweep(dimension);
+            std::vector<std::uint64_t> local_thresholds(cells + 1, 0);
+            std::vector<std::uint64_t> local_largest(cells + 1, 0);
+            for (size_t chunk = next++; chunk < chunks; chunk = next++) {
+                for (size_t trial = chunk * chunk_size; trial < std::min(trials, (chunk + 1) * chunk_size); ++trial) {
+                    Random random(seed, trial);
+                    ++local_thresholds[sweep.run(random, local_largest)];
+                }
+            }
+            std::lock_guard<std::mutex> lock(mutex);
+            for (size_t n = 0; n <= cells; ++n) {
+                thresholds[n] += local_thresholds[n];
+                largest[n] += local_largest[n];
+            }
+        });
+    }
+    pool.wait();
+
+    double sum = 0;
+    for (size_t n = 0; n <= cells; ++n) {
+        sum += double(n) * thresholds[n];
+    }
+    mean = sum / trials / cells;
+    double squares = 0;
+    for (size_t n = 0; n <= cells; ++n) {
+        const double delta = double(n) / cells - mean;
+        squares += delta * delta * thresholds[n];
+    }
+    standard_deviation = sqrt(squares / (trials - 1));
+}
+
+double NewmanZiff::get_mean() const
+{
+    return mean;
+}
+
+double NewmanZiff::get_standard_deviation() const
+{
+    return standard_deviation;
+}
+
+double NewmanZiff::get_confidence_low() const
+{
+    return mean - 1.96 * standard_deviation / sqrt(trials);
+}
+
+double NewmanZiff::get_confidence_high() const
+{
+    return mean + 1.96 * standard_deviation / sqrt(trials);
+}
+
+double NewmanZiff::percolation_probability(size_t opened) const
+{
+    std::uint64_t count = 0;
+    for (size_t n = 0; n <= std::min(opened, cells); ++n) {
+        count += thresholds[n];
+    }
+    return double(count) / trials;
+}
+
+double NewmanZiff::largest_cluster(size_t opened) const
+{
+    return double(largest[std::min(opened, cells)]) / trials / cells;
+}
+
+double NewmanZiff::percolation_probability_at(double p) const
+{
+    std::vector<double> values(cells + 1);
+    std::uint64_t count = 0;
+    for (size_t n = 0; n <= cells; ++n) {
+        count += thresholds[n];
+        values[n] = double(count) / trials;
+    }
+    return convolve(values, p);
+}
+
+double NewmanZiff::largest_cluster_at(double p) const
+{
+    std::vector<double> values(cells + 1);
+    for (size_t n = 0; n <= cells; ++n) {
+        values[n] = double(largest[n]) / trials / cells;
+    }
+    return convolve(values, p);
+}
+
+double NewmanZiff::convolve(const std::vector<double> & values, double p) const
+{
+    if (p <= 0) {
+        return values.front();
+    }
+    if (p >= 1) {
+        return values.back();
+    }
+    // Binomial weights grow from the mode to both sides by their ratios, so no factorials overflow
+    const size_t mode = std::min(cells, size_t(p * (cells + 1)));
+    double weight = 1, total = 1, sum = values[mode];
+    for (size_t n = mode; n < cells && weight > 1e-300; ++n) {
+        weight *= double(cells - n) / (n + 1) * p / (1 - p);
+        total += weight;
+        sum += weight * values[n + 1];
+    }
+    weight = 1;
+    for (size_t n = mode; n > 0 && weight > 1e-300; --n) {
+        weight *= double(n) / (cells - n + 1) * (1 - p) / p;
+        total += weight;
+        sum += weight * values[n - 1];
+    }
+    return sum / total;
+}
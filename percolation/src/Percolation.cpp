@@ -1,64 +1,112 @@
 #include "Percolation.h"
 #include <vector>
 #include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <string>
 
-Percolation::Percolation(size_t dimension) : open_cells(0)
+Percolation::Percolation(size_t dimension)
+    : grid(dimension)
 {
-    table.resize(dimension, std::vector<Type>(dimension, CLOSED));
 }
 
-bool Percolation::check_cell(size_t row, size_t column) const {
-    return row < table.size() && column < table.size();
-}
-void Percolation::dfs(size_t row, size_t column)
+Percolation::Percolation(size_t dimension, const std::vector<std::uint8_t> & bitmap)
+    : grid(dimension, bitmap)
 {
-    table[row][column] = FULL;
+}
 
-    for (size_t i = 0; i < direction.size(); ++i) {
-        size_t cur_row = row + direction[i].first;
-        size_t cur_column = column + direction[i].second;
-        if (check_cell(cur_row, cur_column) && table[cur_row][cur_column] != FULL && table[cur_row][cur_column] == OPEN) {
-            dfs(cur_row, cur_column);
+Percolation Percolation::from_pbm(std::istream & input)
+{
+    std::string magic;
+    size_t width = 0, height = 0;
+    input >> magic;
+    // Comments may follow any header field
+    auto field = [&input](size_t & value) {
+        while (input >> std::ws && input.peek() == '#') {
+            input.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
         }
+        input >> value;
+    };
+    field(width);
+    field(height);
+    if (!input || (magic != "P1" && magic != "P4")) {
+        throw std::runtime_error("not a PBM image");
     }
+    if (width != height) {
+        throw std::runtime_error("PBM image is not square");
+    }
+    std::vector<std::uint8_t> bitmap(width * height);
+    if (magic == "P1") {
+        for (auto & pixel : bitmap) {
+            char c = 0;
+            while (input >> c && c == '#') {
+                input.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+            }
+            if (!input) {
+                throw std::runtime_error("PBM image is truncated");
+            }
+            if (c != '0' && c != '1') {
+                throw std::runtime_error("PBM pixel is neither 0 nor 1");
+            }
+            pixel = c == '1';
+        }
+    } else {
+        input.get();
+        const size_t row_bytes = (width + 7) / 8;
+        std::vector<char> row(row_bytes);
+        for (size_t r = 0; r < height; ++r) {
+            input.read(row.data(), row_bytes);
+            for (size_t column = 0; column < width; ++column) {
+                bitmap[r * width + column] = (row[column / 8] >> (7 - column % 8)) & 1;
+            }
+        }
+    }
+    if (!input) {
+        throw std::runtime_error("PBM image is truncated");
+    }
+    return Percolation(width, bitmap);
+}
+
+void Percolation::reset()
+{
+    grid.reset();
 }
 
 void Percolation::open(size_t row, size_t column)
 {
-    if (table[row][column] != CLOSED) {
-        return;
-    }
-    table[row][column] = OPEN;
-    if (row == 0) {
-        table[row][column] = FULL;
-    }
-    ++open_cells;
-    for (size_t i = 0; i < direction.size(); ++i) {
-        if (is_full(row + direction[i].first, column + direction[i].second)) {
-            dfs(row + direction[i].first, column + direction[i].second);
-            break;
-        }
+    grid.open({row, column});
+}
+
+void Percolation::open_many(const Cell * cells, size_t count)
+{
+    std::vector<size_t> sites(count);
+    for (size_t i = 0; i < count; ++i) {
+        sites[i] = site(cells[i].row, cells[i].column);
     }
+    grid.open_many(sites.data(), count);
+}
+
+void Percolation::open_many(const std::vector<Cell> & cells)
+{
+    open_many(cells.data(), cells.size());
 }
 
 bool Percolation::is_open(size_t row, size_t column) const
 {
-    return check_cell(row, column) && table[row][column];
+    return grid.is_open({row, column});
 }
 
 bool Percolation::is_full(size_t row, size_t column) const
 {
-    return check_cell(row, column) && table[row][column] == FULL;
+    return grid.is_full({row, column});
 }
 
 size_t Percolation::get_numbet_of_open_cells() const
 {
-    return open_cells;
+    return grid.get_number_of_open_units();
 }
 
 bool Percolation::has_percolation() const
 {
-    return std::any_of(table[table.size() - 1].begin(), table[table.size() - 1].end(), [](int i) { return i == FULL; });
+    return grid.has_percolation();
 }
-
-
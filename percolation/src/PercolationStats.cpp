@@ -1,52 +1,180 @@
 #include "PercolationStats.h"
-#include <Percolation.h>
+#include "Percolation.h"
+#include "Random.h"
+#include "ThreadPool.h"
+#include "TrialBatch.h"
+#include <algorithm>
+#include <atomic>
+#include <numeric>
+#include <stdexcept>
+#include <utility>
 #include <vector>
 #include <math.h>
 
-PercolationStats::PercolationStats(size_t dimension, size_t trials) : size (dimension)
+namespace {
+
+const std::uint64_t default_seed = 0;
+
+void check_width(double width)
 {
-    x.clear();
-    for (size_t i = 0; i < trials; ++i) {
-        execute();
+    // Also rejects NaN
+    if (!(width > 0)) {
+        throw std::invalid_argument("confidence interval width must be positive");
     }
 }
 
-double PercolationStats::get_mean() const
+} // namespace
+
+PercolationStats::PercolationStats(size_t dimension, size_t trials)
+    : PercolationStats(dimension, trials, 0, default_seed)
+{
+}
+
+PercolationStats::PercolationStats(size_t dimension, size_t trials, size_t threads, std::uint64_t seed, bool store_trials)
+    : size(dimension)
+    , seed(seed)
+    , store_trials(store_trials)
+    , trial_function([dimension](std::uint64_t seed, std::uint64_t trial) { return run_trial(dimension, seed, trial); })
+{
+    run(0, trials, threads);
+}
+
+PercolationStats::PercolationStats(TrialFunction trial, size_t trials, size_t threads, std::uint64_t seed, bool store_trials)
+    : size(0)
+    , seed(seed)
+    , store_trials(store_trials)
+    , trial_function(std::move(trial))
 {
-    double sum_x = 0;
-    for (size_t i = 0; i < x.size(); ++i) {
-        sum_x += x[i];
+    run(0, trials, threads);
+}
+
+PercolationStats PercolationStats::adaptive(size_t dimension, double width, std::chrono::milliseconds budget,
+                                            size_t threads, std::uint64_t seed, bool store_trials)
+{
+    check_width(width);
+    PercolationStats ans(dimension, 0, threads, seed, store_trials);
+    ans.refine(width, budget, threads);
+    return ans;
+}
+
+PercolationStats PercolationStats::adaptive(TrialFunction trial, double width, std::chrono::milliseconds budget,
+                                            size_t threads, std::uint64_t seed, bool store_trials)
+{
+    check_width(width);
+    PercolationStats ans(std::move(trial), 0, threads, seed, store_trials);
+    ans.refine(width, budget, threads);
+    return ans;
+}
+
+void PercolationStats::refine(double width, std::chrono::milliseconds budget, size_t threads)
+{
+    check_width(width);
+    const auto deadline = budget.count() > 0
+            ? std::chrono::steady_clock::now() + budget
+            : std::chrono::steady_clock::time_point::max();
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    // A chunk for every thread, and never more than doubling the trials
+    const size_t min_batch = threads * TrialBatch::chunk_size;
+    size_t batch = min_batch;
+    while (std::chrono::steady_clock::now() < deadline) {
+        run(stats.count, batch, threads, deadline);
+        const double s = get_standard_deviation();
+        if (get_confidence_high() - get_confidence_low() <= width || s == 0) {
+            break;
+        }
+        // Width is 2 * 1.96 * s / sqrt(n)
+        const double needed = (2 * 1.96 * s / width) * (2 * 1.96 * s / width);
+        const double missing = std::min(needed - stats.count, double(stats.count));
+        batch = std::max(min_batch, size_t(missing));
     }
-    return sum_x / x.size();
+}
+
+double PercolationStats::get_mean() const
+{
+    return mean;
 }
 
 double PercolationStats::get_standard_deviation() const
 {
-    double sum = 0;
-    for (size_t i = 0; i < x.size(); ++i) {
-        sum += (x[i] - get_mean()) * (x[i] - get_mean());
-    }
-    return sqrt(sum / (x.size() - 1));
+    return standard_deviation;
 }
 
 double PercolationStats::get_confidence_low() const
 {
-    return get_mean() - 1.96 * get_standard_deviation() / sqrt(x.size());
+    return confidence_low;
 }
 
 double PercolationStats::get_confidence_high() const
 {
-    return get_mean() + 1.96 * get_standard_deviation() / sqrt(x.size());
+    return confidence_high;
 }
 
 void PercolationStats::execute()
 {
-    Percolation percolation = Percolation(size);
-    while (!percolation.has_percolation()) {
-        int row = rand() % size;
-        int column = rand() % size;
-        percolation.open(row, column);
+    const double value = trial_function(seed, stats.count);
+    if (store_trials) {
+        x.push_back(value);
+    }
+    stats.add(value);
+    update();
+}
+
+void PercolationStats::run(size_t first, size_t count, size_t threads, std::chrono::steady_clock::time_point deadline)
+{
+    if (store_trials) {
+        x.resize(first + count);
+    }
+    TrialBatch batch(trial_function, seed, first, count, store_trials ? x.data() + first : nullptr);
+    const size_t chunks = batch.chunks();
+    std::atomic<size_t> next(0);
+
+    ThreadPool pool(std::min(threads == 0 ? std::thread::hardware_concurrency() : threads, std::max<size_t>(chunks, 1)));
+    for (size_t worker = 0; worker < pool.size(); ++worker) {
+        pool.submit([&] {
+            for (size_t chunk = next++; chunk < chunks && std::chrono::steady_clock::now() < deadline; chunk = next++) {
+                batch.run_chunk(chunk);
+            }
+        });
+    }
+    pool.wait();
+    stats.merge(batch.stats);
+    if (store_trials) {
+        x.resize(stats.count);
     }
-    x.push_back((double)percolation.get_numbet_of_open_cells() / (double)(size * size));
+    update();
+}
+
+void PercolationStats::update()
+{
+    mean = stats.mean;
+    standard_deviation = sqrt(stats.variance());
+    confidence_low = mean - 1.96 * standard_deviation / sqrt(stats.count);
+    confidence_high = mean + 1.96 * standard_deviation / sqrt(stats.count);
 }
 
+double PercolationStats::run_trial(size_t dimension, std::uint64_t seed, std::uint64_t trial)
+{
+    // Grid and permutation are reused by the next trial of the thread
+    thread_local size_t grid_dimension = 0;
+    thread_local Percolation percolation(0);
+    thread_local std::vector<std::uint32_t> order;
+    if (grid_dimension != dimension) {
+        grid_dimension = dimension;
+        percolation = Percolation(dimension);
+    } else {
+        percolation.reset();
+    }
+    order.resize(dimension * dimension);
+    std::iota(order.begin(), order.end(), 0);
+
+    Random random(seed, trial);
+    // Cells are opened in the order of a random permutation that is shuffled
+    // one position ahead of the opening, so every draw opens a closed cell
+    for (size_t i = 0; !percolation.has_percolation(); ++i) {
+        std::swap(order[i], order[i + random.below(order.size() - i)]);
+        percolation.open(order[i] / dimension, order[i] % dimension);
+    }
+    return (double)percolation.get_numbet_of_open_cells() / (double)(dimension * dimension);
+}
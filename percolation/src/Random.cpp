@@ -0,0 +1,50 @@
+#include "Random.h"
+
+namespace {
+
+std::uint64_t splitmix(std::uint64_t & x)
+{
+    std::uint64_t z = (x += 0x9E3779B97F4A7C15);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EB;
+    return z ^ (z >> 31);
+}
+
+std::uint64_t rotl(std::uint64_t x, int k)
+{
+    return (x << k) | (x >> (64 - k));
+}
+
+} // namespace
+
+Random::Random(std::uint64_t seed, std::uint64_t stream)
+{
+    std::uint64_t x = seed;
+    x ^= splitmix(stream);
+    for (std::uint64_t & word : state) {
+        word = splitmix(x);
+    }
+}
+
+Random::result_type Random::operator()()
+{
+    const std::uint64_t result = rotl(state[1] * 5, 7) * 9;
+    const std::uint64_t t = state[1] << 17;
+    state[2] ^= state[0];
+    state[3] ^= state[1];
+    state[1] ^= state[2];
+    state[0] ^= state[3];
+    state[2] ^= t;
+    state[3] = rotl(state[3], 45);
+    return result;
+}
+
+std::uint64_t Random::below(std::uint64_t bound)
+{
+    const std::uint64_t limit = UINT64_MAX - UINT64_MAX % bound;
+    std::uint64_t x;
+    do {
+        x = (*this)();
+    } while (x >= limit);
+    return x % bound;
+}
@@ -0,0 +1,27 @@
+#include "RunningStats.h"
+#include <limits>
+
+void RunningStats::add(double value)
+{
+    ++count;
+    const double delta = value - mean;
+    mean += delta / count;
+    m2 += delta * (value - mean);
+}
+
+void RunningStats::merge(const RunningStats & other)
+{
+    if (other.count == 0) {
+        return;
+    }
+    const std::uint64_t total = count + other.count;
+    const double delta = other.mean - mean;
+    mean += delta * other.count / total;
+    m2 += other.m2 + delta * delta * count * other.count / total;
+    count = total;
+}
+
+double RunningStats::variance() const
+{
+    return count > 1 ? m2 / (count - 1) : std::numeric_limits<double>::quiet_NaN();
+}
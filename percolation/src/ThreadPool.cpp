@@ -0,0 +1,105 @@
+#include "ThreadPool.h"
+#include <algorithm>
+#include <utility>
+
+ThreadPool::ThreadPool(size_t threads) : queued(0), unfinished(0), next_queue(0), stop(false)
+{
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    for (size_t i = 0; i < threads; ++i) {
+        queues.push_back(std::make_unique<Queue>());
+    }
+    for (size_t i = 0; i < threads; ++i) {
+        workers.emplace_back([this, i] { work(i); });
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stop = true;
+    }
+    ready.notify_all();
+    for (auto & worker : workers) {
+        worker.join();
+    }
+}
+
+size_t ThreadPool::size() const
+{
+    return workers.size();
+}
+
+void ThreadPool::submit(std::function<void()> task)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    Queue & queue = *queues[next_queue];
+    next_queue = (next_queue + 1) % queues.size();
+    {
+        std::lock_guard<std::mutex> queue_lock(queue.mutex);
+        queue.tasks.push_back(std::move(task));
+    }
+    ++queued;
+    ++unfinished;
+    ready.notify_one();
+}
+
+void ThreadPool::wait()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [this] { return unfinished == 0; });
+    if (error) {
+        std::rethrow_exception(std::exchange(error, nullptr));
+    }
+}
+
+bool ThreadPool::pop(size_t worker, std::function<void()> & task)
+{
+    for (size_t i = 0; i < queues.size(); ++i) {
+        Queue & queue = *queues[(worker + i) % queues.size()];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty()) {
+            continue;
+        }
+        if (i == 0) {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+        } else {
+            task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+        }
+        --queued;
+        return true;
+    }
+    return false;
+}
+
+void ThreadPool::work(size_t worker)
+{
+    std::function<void()> task;
+    while (true) {
+        if (pop(worker, task)) {
+            try {
+                task();
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (!error) {
+                    error = std::current_exception();
+                }
+            }
+            task = nullptr;
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--unfinished == 0) {
+                done.notify_all();
+            }
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(mutex);
+        ready.wait(lock, [this] { return stop || queued > 0; });
+        if (stop && queued == 0) {
+            return;
+        }
+    }
+}
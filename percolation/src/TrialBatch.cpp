@@ -0,0 +1,53 @@
+#include "TrialBatch.h"
+#include <algorithm>
+#include <utility>
+
+TrialBatch::TrialBatch(TrialFunction trial, std::uint64_t seed, size_t first, size_t count, double * results)
+    : trial(std::move(trial))
+    , seed(seed)
+    , first(first)
+    , count(count)
+    , results(results)
+    , merged(0)
+    , started(false)
+    , seconds(0)
+{
+}
+
+size_t TrialBatch::chunks() const
+{
+    return (count + chunk_size - 1) / chunk_size;
+}
+
+bool TrialBatch::run_chunk(size_t chunk)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!started) {
+            started = true;
+            start_time = std::chrono::steady_clock::now();
+        }
+    }
+    RunningStats part;
+    const size_t end = std::min(count, (chunk + 1) * chunk_size);
+    for (size_t i = chunk * chunk_size; i < end; ++i) {
+        const double value = trial(seed, first + i);
+        if (results != nullptr) {
+            results[i] = value;
+        }
+        part.add(value);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    pending.emplace(chunk, part);
+    const size_t before = merged;
+    for (auto it = pending.begin(); it != pending.end() && it->first == merged; it = pending.erase(it)) {
+        stats.merge(it->second);
+        ++merged;
+    }
+    if (merged == chunks() && merged != before) {
+        seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,54 @@
+#include "UnionFind.h"
+#include <algorithm>
+#include <utility>
+#include <stdexcept>
+
+UnionFind::UnionFind(size_t count) : parent(count)
+{
+    if (count > first_root) {
+        throw std::length_error("too many elements for UnionFind");
+    }
+    reset();
+}
+
+void UnionFind::reset()
+{
+    std::fill(parent.begin(), parent.end(), first_root);
+}
+
+size_t UnionFind::find(size_t element)
+{
+    while (!is_root(element)) {
+        const size_t up = parent[element];
+        if (!is_root(up)) {
+            parent[element] = parent[up];
+        }
+        element = parent[element];
+    }
+    return element;
+}
+
+size_t UnionFind::root(size_t element) const
+{
+    // Union by rank keeps the paths logarithmic
+    while (!is_root(element)) {
+        element = parent[element];
+    }
+    return element;
+}
+
+size_t UnionFind::unite(size_t lhs, size_t rhs)
+{
+    if (lhs == rhs) {
+        return lhs;
+    }
+    const std::uint32_t rank_mask = (1u << rank_bits) - 1;
+    if ((mark(lhs) & rank_mask) < (mark(rhs) & rank_mask)) {
+        std::swap(lhs, rhs);
+    }
+    const bool grows = (mark(lhs) & rank_mask) == (mark(rhs) & rank_mask);
+    parent[lhs] |= mark(rhs) & ~rank_mask;
+    parent[lhs] += grows;
+    parent[rhs] = lhs;
+    return lhs;
+}
@@ -1,14 +1,174 @@
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <functional>
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <math.h>
 
-#include "Percolation.h"
+#include "LatticePercolation.h"
+#include "NewmanZiff.h"
 #include "PercolationStats.h"
+#include "ThreadPool.h"
+#include "TrialBatch.h"
 
-int main()
+namespace {
+
+void usage()
 {
-    const size_t dimension = 5;
-    const size_t trials = 100;
-    PercolationStats percolation_stats(dimension, trials);
-    std::cout << "mean = " << percolation_stats.get_mean() << std::endl;
+    std::cerr << "Usage: percolation [--sizes N,N,...] [--trials T] [--threads N] [--seed S] [--output FILE]\n"
+              << "                   [--lattice square|moore|triangular|cubic] [--bond] [--newman-ziff]\n"
+              << "Runs T (at least 1) trials for every grid size on one shared pool and writes a CSV line per size\n"
+              << "as soon as it is done: size, trials, mean, stddev, confidence interval, wall time.\n"
+              << "--newman-ziff opens every site of each trial in one sweep instead, one size at a time;\n"
+              << "it gives the same thresholds for the seed and is for site percolation on the square lattice only." << std::endl;
+}
+
+bool parse_sizes(const std::string & list, std::vector<size_t> & sizes)
+{
+    std::istringstream input(list);
+    std::string item;
+    sizes.clear();
+    while (std::getline(input, item, ',')) {
+        try {
+            sizes.push_back(std::stoul(item));
+        } catch (const std::exception &) {
+            return false;
+        }
+        if (sizes.back() == 0) {
+            return false;
+        }
+    }
+    return !sizes.empty();
+}
+
+template <typename Lattice>
+TrialFunction lattice(size_t size, bool bond)
+{
+    return bond ? lattice_trials<BondPercolation<Lattice> >(size) : lattice_trials<SitePercolation<Lattice> >(size);
+}
+
+bool make_trials(const std::string & name, bool bond, size_t size, TrialFunction & trial)
+{
+    if (name == "square" && !bond) {
+        trial = [size](std::uint64_t seed, std::uint64_t trial) { return PercolationStats::run_trial(size, seed, trial); };
+    } else if (name == "square") {
+        trial = lattice<Square>(size, bond);
+    } else if (name == "moore") {
+        trial = lattice<Moore>(size, bond);
+    } else if (name == "triangular") {
+        trial = lattice<Triangular>(size, bond);
+    } else if (name == "cubic") {
+        trial = lattice<Cubic>(size, bond);
+    } else {
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char * argv[])
+{
+    std::vector<size_t> sizes = {5};
+    size_t trials = 100;
+    size_t threads = 0;
+    std::uint64_t seed = 0;
+    std::string output_path;
+    std::string lattice_name = "square";
+    bool bond = false;
+    bool newman_ziff = false;
+    try {
+        for (int i = 1; i < argc; ++i) {
+            const std::string arg = argv[i];
+            if (arg == "--sizes" && i + 1 < argc) {
+                if (!parse_sizes(argv[++i], sizes)) {
+                    usage();
+                    return 1;
+                }
+            } else if (arg == "--trials" && i + 1 < argc && std::stoull(argv[i + 1]) > 0) {
+                trials = std::stoull(argv[++i]);
+            } else if (arg == "--threads" && i + 1 < argc) {
+                threads = std::stoul(argv[++i]);
+            } else if (arg == "--seed" && i + 1 < argc) {
+                seed = std::stoull(argv[++i]);
+            } else if (arg == "--lattice" && i + 1 < argc) {
+                lattice_name = argv[++i];
+            } else if (arg == "--bond") {
+                bond = true;
+            } else if (arg == "--newman-ziff") {
+                newman_ziff = true;
+            } else if (arg == "--output" && i + 1 < argc) {
+                output_path = argv[++i];
+            } else {
+                usage();
+                return 1;
+            }
+        }
+    } catch (const std::logic_error &) {
+        usage();
+        return 1;
+    }
+
+    TrialFunction probe;
+    if (!make_trials(lattice_name, bond, 1, probe) || (newman_ziff && (bond || lattice_name != "square"))) {
+        usage();
+        return 1;
+    }
+
+    std::ofstream file;
+    if (!output_path.empty()) {
+        file.open(output_path);
+        if (!file) {
+            std::cerr << "Can't write " << output_path << std::endl;
+            return 1;
+        }
+    }
+    std::ostream & out = output_path.empty() ? std::cout : file;
+    out << "size,trials,mean,stddev,confidence_low,confidence_high,seconds" << std::endl;
+
+    // Largest grids go first so that they don't finish alone at the end
+    std::sort(sizes.begin(), sizes.end(), std::greater<size_t>());
+    if (newman_ziff) {
+        for (const size_t size : sizes) {
+            const auto started = std::chrono::steady_clock::now();
+            const NewmanZiff sweep(size, trials, threads, seed);
+            const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+            out << size << "," << trials << "," << sweep.get_mean() << "," << sweep.get_standard_deviation() << ","
+                << sweep.get_confidence_low() << "," << sweep.get_confidence_high() << "," << seconds << std::endl;
+        }
+        return 0;
+    }
+    std::vector<std::unique_ptr<TrialBatch> > batches;
+    for (const size_t size : sizes) {
+        TrialFunction trial;
+        make_trials(lattice_name, bond, size, trial);
+        batches.push_back(std::make_unique<TrialBatch>(trial, seed, 0, trials));
+    }
+    std::mutex output_mutex;
+    ThreadPool pool(threads);
+    for (size_t i = 0; i < batches.size(); ++i) {
+        for (size_t chunk = 0; chunk < batches[i]->chunks(); ++chunk) {
+            pool.submit([&, i, chunk] {
+                TrialBatch & batch = *batches[i];
+                if (!batch.run_chunk(chunk)) {
+                    return;
+                }
+                const RunningStats & stats = batch.stats;
+                const double deviation = sqrt(stats.variance());
+                const double margin = 1.96 * deviation / sqrt(stats.count);
+                std::lock_guard<std::mutex> lock(output_mutex);
+                out << sizes[i] << "," << stats.count << "," << stats.mean << "," << deviation << ","
+                    << stats.mean - margin << "," << stats.mean + margin << "," << batch.seconds << std::endl;
+            });
+        }
+    }
+    pool.wait();
 
     return 0;
 }
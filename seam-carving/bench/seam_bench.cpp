@@ -0,0 +1,144 @@
+#include "Image.h"
+#include "SeamCarver.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+ * Times the seam search of one thread against several threads on seeded
+ * random images, 4K and 8K among them, and checks that both find the same
+ * seams while seams are removed. Prints one JSON object, the exit code is 2
+ * when the seams differ.
+ */
+
+namespace {
+
+struct Options
+{
+    std::uint64_t seed = 1;
+    size_t seams = 4;
+    size_t threads = std::max(2u, std::thread::hardware_concurrency());
+    bool large = true;
+};
+
+struct Size
+{
+    size_t width;
+    size_t height;
+};
+
+const Size sizes[] = {{1024, 768}, {3840, 2160}, {7680, 4320}};
+
+void usage()
+{
+    std::cerr << "Usage: seam_bench [--seed N] [--seams N] [--threads N] [--small]\n"
+              << "--seams (at least 1) is the number of vertical and horizontal seams found and removed per image,\n"
+              << "--threads (at least 2) is the thread count compared with one thread,\n"
+              << "--small skips the 8K image." << std::endl;
+}
+
+Image RandomImage(const Size size, std::mt19937_64& random)
+{
+    const size_t stride = size.width * Image::channels;
+    std::vector<std::uint8_t> data(stride * size.height);
+    for (auto& byte : data) {
+        byte = random() & 0xff;
+    }
+    return Image(size.width, size.height, stride, std::move(data));
+}
+
+double Seconds(std::chrono::steady_clock::time_point started)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+}
+
+/**
+ * Finds and removes seams on both carvers in turn
+ * @return true when every seam is the same
+ */
+bool RunImage(std::ostream& out, bool& first, const Size size, const Options& options, std::mt19937_64& random)
+{
+    const Image image = RandomImage(size, random);
+    SeamCarver serial(image, 1);
+    SeamCarver parallel(image, options.threads);
+    double serialSeconds = 0;
+    double parallelSeconds = 0;
+    bool same = true;
+    for (size_t i = 0; i < options.seams; ++i) {
+        for (const bool vertical : {true, false}) {
+            auto started = std::chrono::steady_clock::now();
+            const auto expected = vertical ? serial.FindVerticalSeam() : serial.FindHorizontalSeam();
+            serialSeconds += Seconds(started);
+            started = std::chrono::steady_clock::now();
+            const auto seam = vertical ? parallel.FindVerticalSeam() : parallel.FindHorizontalSeam();
+            parallelSeconds += Seconds(started);
+            same = same && seam == expected;
+            if (vertical) {
+                serial.RemoveVerticalSeam(expected);
+                parallel.RemoveVerticalSeam(expected);
+            } else {
+                serial.RemoveHorizontalSeam(expected);
+                parallel.RemoveHorizontalSeam(expected);
+            }
+        }
+    }
+
+    out << (first ? "" : ",") << "\n    {\"width\": " << size.width
+        << ", \"height\": " << size.height
+        << ", \"seams\": " << 2 * options.seams
+        << ", \"threads\": " << options.threads
+        << ", \"serial_seconds\": " << serialSeconds
+        << ", \"parallel_seconds\": " << parallelSeconds
+        << ", \"speedup\": " << (parallelSeconds > 0 ? serialSeconds / parallelSeconds : 0)
+        << ", \"same\": " << (same ? "true" : "false") << "}";
+    first = false;
+    return same;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    Options options;
+    try {
+        for (int i = 1; i < argc; ++i) {
+            const std::string arg = argv[i];
+            if (arg == "--seed" && i + 1 < argc) {
+                options.seed = std::stoull(argv[++i]);
+            } else if (arg == "--seams" && i + 1 < argc && std::stoul(argv[i + 1]) > 0) {
+                options.seams = std::stoul(argv[++i]);
+            } else if (arg == "--threads" && i + 1 < argc && std::stoul(argv[i + 1]) > 1) {
+                options.threads = std::stoul(argv[++i]);
+            } else if (arg == "--small") {
+                options.large = false;
+            } else {
+                usage();
+                return 1;
+            }
+        }
+    } catch (const std::logic_error&) {
+        usage();
+        return 1;
+    }
+
+    std::mt19937_64 random(options.seed);
+    std::cout << "{\n  \"seed\": " << options.seed << ",\n  \"results\": [";
+    bool first = true;
+    bool same = true;
+    for (const Size size : sizes) {
+        if (!options.large && size.width > 4096) {
+            continue;
+        }
+        same = RunImage(std::cout, first, size, options, random) && same;
+        std::cout.flush();
+    }
+    std::cout << "\n  ]\n}" << std::endl;
+    return same ? 0 : 2;
+}
@@ -0,0 +1,15 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * Computes energies of the pixels [first, last] of a row,
+ * neighbours outside the row are wrapped around it
+ * @param up packed RGB8 row above, the last one for the first row
+ * @param row packed RGB8 row
+ * @param down packed RGB8 row below, the first one for the last row
+ * @param width row width in pixels
+ * @param energy energies of the row, indexed by column
+ */
+void ComputeRowEnergy(const std::uint8_t* up, const std::uint8_t* row, const std::uint8_t* down,
+                      size_t width, size_t first, size_t last, double* energy);
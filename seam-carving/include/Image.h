@@ -1,4 +1,5 @@
 #pragma once
+#include <cstdint>
 #include <iostream>
 
 #include <vector>
@@ -9,16 +10,58 @@ struct Image
 {
     struct Pixel
     {
-        Pixel(int red, int green, int blue);
-        Pixel();
+        Pixel(int red, int green, int blue)
+            : m_red(red)
+            , m_green(green)
+            , m_blue(blue)
+        {}
+
+        Pixel()
+            : Pixel(0, 0, 0)
+        {}
+
         int m_red;
         int m_green;
         int m_blue;
     };
 
+    static constexpr size_t channels = 3;
+
+    /**
+     * Builds an image from a table indexed [column][row]
+     * @throw std::out_of_range if a channel is outside 0..255
+     */
     Image(std::vector<std::vector<Pixel>> table);
 
-    Pixel GetPixel(size_t columnId, size_t rowId) const;
+    /**
+     * Builds an image from a packed RGB8 buffer
+     * @param data row-major pixels, stride bytes per row
+     */
+    Image(size_t width, size_t height, size_t stride, std::vector<std::uint8_t> data);
+
+    /**
+     * Returns a copy of the pixels as a table indexed [column][row], the layout
+     * the public m_table member had before pixels were packed into one buffer
+     */
+    std::vector<std::vector<Pixel>> GetTable() const;
+
+    Pixel GetPixel(size_t columnId, size_t rowId) const
+    {
+        const std::uint8_t* pixel = GetRow(rowId) + columnId * channels;
+        return Pixel(pixel[0], pixel[1], pixel[2]);
+    }
+
+    /**
+     * Returns first byte of the row, pixels are packed as R, G, B
+     */
+    const std::uint8_t* GetRow(size_t rowId) const
+    { return m_data.data() + rowId * m_stride; }
+
+    /**
+     * Returns distance between rows in bytes, it doesn't shrink when seams are removed
+     */
+    size_t GetStride() const
+    { return m_stride; }
 
     void RemoveVerticalSeam(const Seam& seam);
 
@@ -28,5 +71,12 @@ struct Image
 
     size_t GetWidth() const;
 
-    std::vector<std::vector<Pixel>> m_table;
-};
\ No newline at end of file
+private:
+    std::uint8_t* MutableRow(size_t rowId)
+    { return m_data.data() + rowId * m_stride; }
+
+    size_t m_width;
+    size_t m_height;
+    size_t m_stride;
+    std::vector<std::uint8_t> m_data;
+};
@@ -0,0 +1,34 @@
+#pragma once
+#include <string>
+
+#include "Image.h"
+
+/**
+ * Image file formats, the format of a file is picked by its extension:
+ * .csv  "W H" followed by "R G B" lines in column-major order, as the scripts use
+ * .ppm  binary PPM (P6) with 8-bit channels
+ * .rgb8 "RGB8" magic, 32-bit little-endian width and height, raw row-major RGB8 pixels
+ */
+enum class ImageFormat
+{
+    CSV,
+    PPM,
+    RGB8
+};
+
+/**
+ * Picks the format by the file extension, CSV when it's unknown
+ */
+ImageFormat GetImageFormat(const std::string& filename);
+
+/**
+ * Reads an image, the file is memory mapped and parsed in place
+ * @throw std::runtime_error when the file can't be read or is malformed
+ */
+Image ReadImage(const std::string& filename, ImageFormat format);
+
+/**
+ * Writes an image through one buffer
+ * @throw std::runtime_error when the file can't be written
+ */
+void WriteImage(const Image& image, const std::string& filename, ImageFormat format);
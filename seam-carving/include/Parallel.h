@@ -0,0 +1,36 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <functional>
+
+/**
+ * Splits [0, count) into contiguous ranges and runs them on separate threads
+ * @param grain smallest range worth a thread of its own
+ * @param body called with [begin, end) of every range
+ * @param threads most threads to use, 0 is one per hardware thread
+ */
+void ParallelFor(size_t count, size_t grain, const std::function<void(size_t begin, size_t end)>& body, size_t threads = 0);
+
+/**
+ * Number of threads ParallelFor uses for the count of threads requested
+ */
+size_t ParallelThreads(size_t threads);
+
+/**
+ * Reusable barrier for threads that work in lockstep, waiting threads yield
+ */
+class Barrier
+{
+public:
+    explicit Barrier(size_t count);
+
+    /**
+     * Blocks until all `count` threads have called it
+     */
+    void Wait();
+
+private:
+    const size_t m_count;
+    std::atomic<size_t> m_waiting{0};
+    std::atomic<size_t> m_phase{0};
+};
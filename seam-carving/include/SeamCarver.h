@@ -7,7 +7,10 @@ class SeamCarver
     using Seam = std::vector<size_t>;
 
 public:
-    SeamCarver(Image image);
+    /**
+     * @param threads most threads for energy and seam search, 0 is one per hardware thread
+     */
+    SeamCarver(Image image, size_t threads = 0);
 
     /**
      * Returns current image
@@ -54,5 +57,35 @@ public:
     void RemoveVerticalSeam(const Seam& seam);
 
 private:
+    /**
+     * Finds the cheapest path of `length` steps, moving at most one cell across
+     * `breadth` cells on every step. Wide steps are split between threads.
+     * Scratch memory is local to the call, so searches on one carver may run concurrently
+     * @param energy row-major energies, one row per step
+     * @param stride distance between the energies of consecutive steps
+     * @return cell index of every step
+     */
+    Seam FindSeam(const double* energy, size_t length, size_t breadth, size_t stride) const;
+
+    double& Energy(size_t columnId, size_t rowId)
+    { return m_energy[rowId * m_energyStride + columnId]; }
+
+    /**
+     * Recomputes energies of rows [first, last] of the column
+     */
+    void UpdateColumnEnergy(size_t columnId, size_t first, size_t last);
+
+    /**
+     * Recomputes energies of columns [first, last] of the row
+     */
+    void UpdateRowEnergy(size_t rowId, size_t first, size_t last);
+
     Image m_image;
+
+    // Energies of the current image, row-major with the original width as a stride.
+    // Seam removal shifts them like the pixels and recomputes only the seam neighbourhood
+    std::vector<double> m_energy;
+    size_t m_energyStride;
+
+    size_t m_threads;
 };
\ No newline at end of file
@@ -0,0 +1,15 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * Relaxes cells [first, last) of one step of the seam search: every cell takes
+ * the cheapest of its three parents in the previous step, ties go to the leftmost
+ * @param previous cumulative costs of the previous step
+ * @param energy energies of the step
+ * @param breadth number of cells in a step
+ * @param current cumulative costs of the step
+ * @param parent parent offsets (-1, 0, +1) of the step
+ */
+void RelaxRow(const double* previous, const double* energy, size_t breadth, size_t first, size_t last,
+              double* current, std::int8_t* parent);
@@ -0,0 +1,121 @@
+#include "Energy.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace {
+
+const size_t channels = 3;
+
+// Pixels handled at once by the inner column kernel
+const size_t blockSize = 64;
+
+int Square(int value)
+{
+    return value * value;
+}
+
+/**
+ * Squared differences of the channels between the horizontal and the vertical
+ * neighbours, out[i] = (right[i] - left[i])^2 + (down[i] - up[i])^2
+ */
+void ChannelGradients(const std::uint8_t* left, const std::uint8_t* right,
+                      const std::uint8_t* up, const std::uint8_t* down, size_t count, std::int32_t* out)
+{
+    size_t i = 0;
+#if defined(__AVX2__)
+    auto load = [](const std::uint8_t* bytes) {
+        return _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes)));
+    };
+    for (; i + 16 <= count; i += 16) {
+        const __m256i dx = _mm256_sub_epi16(load(right + i), load(left + i));
+        const __m256i dy = _mm256_sub_epi16(load(down + i), load(up + i));
+        // Interleaved (dx, dy) pairs, madd of a pair with itself is dx^2 + dy^2
+        const __m256i low = _mm256_unpacklo_epi16(dx, dy);
+        const __m256i high = _mm256_unpackhi_epi16(dx, dy);
+        const __m256i lowSums = _mm256_madd_epi16(low, low);
+        const __m256i highSums = _mm256_madd_epi16(high, high);
+        // Unpacking works within 128-bit lanes, restore the element order
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_permute2x128_si256(lowSums, highSums, 0x20));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i + 8), _mm256_permute2x128_si256(lowSums, highSums, 0x31));
+    }
+#elif defined(__SSE2__)
+    const __m128i zero = _mm_setzero_si128();
+    auto load = [zero](const std::uint8_t* bytes) {
+        return _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(bytes)), zero);
+    };
+    for (; i + 8 <= count; i += 8) {
+        const __m128i dx = _mm_sub_epi16(load(right + i), load(left + i));
+        const __m128i dy = _mm_sub_epi16(load(down + i), load(up + i));
+        const __m128i low = _mm_unpacklo_epi16(dx, dy);
+        const __m128i high = _mm_unpackhi_epi16(dx, dy);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_madd_epi16(low, low));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i + 4), _mm_madd_epi16(high, high));
+    }
+#endif
+    for (; i < count; ++i) {
+        out[i] = Square(right[i] - left[i]) + Square(down[i] - up[i]);
+    }
+}
+
+/**
+ * Sums the channel gradients of every pixel and takes the square root. The sums
+ * are exact integers, so the result doesn't depend on the instruction set
+ */
+void PixelEnergies(const std::int32_t* gradients, size_t count, double* energy)
+{
+    auto sum = [gradients](size_t x) {
+        return gradients[x * channels] + gradients[x * channels + 1] + gradients[x * channels + 2];
+    };
+    size_t x = 0;
+#if defined(__AVX2__)
+    for (; x + 4 <= count; x += 4) {
+        const __m128i sums = _mm_setr_epi32(sum(x), sum(x + 1), sum(x + 2), sum(x + 3));
+        _mm256_storeu_pd(energy + x, _mm256_sqrt_pd(_mm256_cvtepi32_pd(sums)));
+    }
+#elif defined(__SSE2__)
+    for (; x + 2 <= count; x += 2) {
+        const __m128i sums = _mm_setr_epi32(sum(x), sum(x + 1), 0, 0);
+        _mm_storeu_pd(energy + x, _mm_sqrt_pd(_mm_cvtepi32_pd(sums)));
+    }
+#endif
+    for (; x < count; ++x) {
+        energy[x] = std::sqrt(double(sum(x)));
+    }
+}
+
+double PixelEnergy(const std::uint8_t* left, const std::uint8_t* right, const std::uint8_t* up, const std::uint8_t* down)
+{
+    std::int32_t gradients[channels];
+    ChannelGradients(left, right, up, down, channels, gradients);
+    double energy;
+    PixelEnergies(gradients, 1, &energy);
+    return energy;
+}
+
+} // namespace
+
+void ComputeRowEnergy(const std::uint8_t* up, const std::uint8_t* row, const std::uint8_t* down,
+                      size_t width, size_t first, size_t last, double* energy)
+{
+    // The edge columns wrap around, the inner ones have both neighbours in the row
+    for (const size_t columnId : {size_t(0), width - 1}) {
+        if (first <= columnId && columnId <= last) {
+            const size_t left = (columnId + width - 1) % width;
+            const size_t right = (columnId + 1) % width;
+            energy[columnId] = PixelEnergy(row + left * channels, row + right * channels,
+                                           up + columnId * channels, down + columnId * channels);
+        }
+    }
+    std::int32_t gradients[blockSize * channels];
+    const size_t end = std::min(last + 1, width - 1);
+    for (size_t columnId = std::max(first, size_t(1)); columnId < end; columnId += blockSize) {
+        const size_t count = std::min(blockSize, end - columnId);
+        const size_t offset = columnId * channels;
+        ChannelGradients(row + offset - channels, row + offset + channels, up + offset, down + offset, count * channels, gradients);
+        PixelEnergies(gradients, count, energy + columnId);
+    }
+}
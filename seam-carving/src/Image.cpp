@@ -1,51 +1,79 @@
 #include "Image.h"
+#include <cstring>
+#include <stdexcept>
 using Seam = std::vector<size_t>;
 
 Image::Image(std::vector<std::vector<Image::Pixel>> table)
-    : m_table(std::move(table))
-{}
-
-Image::Pixel::Pixel(int red, int green, int blue)
-    : m_red(red)
-    , m_green(green)
-    , m_blue(blue)
-{}
+    : m_width(table.size())
+    , m_height(table.empty() ? 0 : table[0].size())
+    , m_stride(m_width * channels)
+    , m_data(m_stride * m_height)
+{
+    for (size_t columnId = 0; columnId < m_width; ++columnId) {
+        for (size_t rowId = 0; rowId < m_height; ++rowId) {
+            const Pixel& pixel = table[columnId][rowId];
+            for (const int channel : {pixel.m_red, pixel.m_green, pixel.m_blue}) {
+                if (channel < 0 || channel > 255) {
+                    throw std::out_of_range("pixel channel is outside 0..255");
+                }
+            }
+            std::uint8_t* target = MutableRow(rowId) + columnId * channels;
+            target[0] = pixel.m_red;
+            target[1] = pixel.m_green;
+            target[2] = pixel.m_blue;
+        }
+    }
+}
 
-Image::Pixel::Pixel()
-    : m_red(0)
-    , m_green(0)
-    , m_blue(0)
+Image::Image(size_t width, size_t height, size_t stride, std::vector<std::uint8_t> data)
+    : m_width(width)
+    , m_height(height)
+    , m_stride(stride)
+    , m_data(std::move(data))
 {}
 
-
-Image::Pixel Image::GetPixel(size_t columnId, size_t rowId) const
+std::vector<std::vector<Image::Pixel>> Image::GetTable() const
 {
-    return m_table[columnId][rowId];
+    std::vector<std::vector<Pixel>> table(m_width, std::vector<Pixel>(m_height));
+    for (size_t rowId = 0; rowId < m_height; ++rowId) {
+        for (size_t columnId = 0; columnId < m_width; ++columnId) {
+            table[columnId][rowId] = GetPixel(columnId, rowId);
+        }
+    }
+    return table;
 }
 
 void Image::RemoveHorizontalSeam(const Seam& seam)
 {
-    for (size_t i = 0; i < seam.size(); ++i) {
-        m_table[i].erase(m_table[i].begin() + seam[i]);
+    // Rows are visited in memory order, each pixel below the seam moves one row up
+    for (size_t rowId = 0; rowId + 1 < m_height; ++rowId) {
+        std::uint8_t* row = MutableRow(rowId);
+        const std::uint8_t* next = GetRow(rowId + 1);
+        for (size_t i = 0; i < seam.size(); ++i) {
+            if (seam[i] <= rowId) {
+                std::memcpy(row + i * channels, next + i * channels, channels);
+            }
+        }
     }
+    --m_height;
 }
 
 void Image::RemoveVerticalSeam(const Seam& seam)
 {
+    // Rows keep their stride, the tail of every row is shifted in place
     for (size_t i = 0; i < seam.size(); ++i) {
-        for (size_t rowId = seam[i]; rowId < GetWidth() - 1; ++rowId) {
-            m_table[rowId][i] = m_table[rowId + 1][i];
-        }
+        std::uint8_t* row = MutableRow(i);
+        std::memmove(row + seam[i] * channels, row + (seam[i] + 1) * channels, (m_width - seam[i] - 1) * channels);
     }
-    m_table.resize(m_table.size() - 1);
+    --m_width;
 }
 
 size_t Image::GetHeight() const
 {
-    return m_table[0].size();
+    return m_height;
 }
 
 size_t Image::GetWidth() const
 {
-    return m_table.size();
+    return m_width;
 }
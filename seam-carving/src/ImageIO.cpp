@@ -0,0 +1,336 @@
+#include "ImageIO.h"
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+const char rgb8Magic[4] = {'R', 'G', 'B', '8'};
+
+// Output is flushed to the file in pieces of this size
+const size_t outputBufferSize = size_t(1) << 20;
+
+/**
+ * Read-only mapping of a whole file
+ */
+class MappedFile
+{
+public:
+    explicit MappedFile(const std::string& filename)
+    {
+        const int descriptor = open(filename.c_str(), O_RDONLY);
+        if (descriptor < 0) {
+            throw std::runtime_error("can't open " + filename);
+        }
+        struct stat status;
+        if (fstat(descriptor, &status) == 0 && status.st_size > 0) {
+            m_size = status.st_size;
+            void* data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+            m_data = data == MAP_FAILED ? nullptr : static_cast<const char*>(data);
+        }
+        close(descriptor);
+        if (m_size > 0 && m_data == nullptr) {
+            throw std::runtime_error("can't map " + filename);
+        }
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    ~MappedFile()
+    {
+        if (m_data != nullptr) {
+            munmap(const_cast<char*>(m_data), m_size);
+        }
+    }
+
+    const char* begin() const
+    { return m_data; }
+
+    const char* end() const
+    { return m_data + m_size; }
+
+private:
+    const char* m_data = nullptr;
+    size_t m_size = 0;
+};
+
+/**
+ * Parses unsigned numbers separated by whitespace and, in PPM headers, comments
+ */
+class Scanner
+{
+public:
+    Scanner(const char* begin, const char* end)
+        : m_position(begin)
+        , m_end(end)
+    {}
+
+    size_t Number(bool comments = false)
+    {
+        while (m_position < m_end && (IsSpace(*m_position) || (comments && *m_position == '#'))) {
+            if (*m_position == '#') {
+                m_position = std::find(m_position, m_end, '\n');
+            } else {
+                ++m_position;
+            }
+        }
+        size_t value = 0;
+        const auto [next, error] = std::from_chars(m_position, m_end, value);
+        if (error != std::errc()) {
+            throw std::runtime_error("malformed image file");
+        }
+        m_position = next;
+        return value;
+    }
+
+    std::uint8_t Channel()
+    {
+        const size_t value = Number();
+        if (value > 255) {
+            throw std::runtime_error("channel value is out of range");
+        }
+        return value;
+    }
+
+    const char* Position() const
+    { return m_position; }
+
+private:
+    static bool IsSpace(char c)
+    { return c == ' ' || c == '\n' || c == '\r' || c == '\t'; }
+
+    const char* m_position;
+    const char* m_end;
+};
+
+/**
+ * Collects output in a buffer and writes it to the file in large pieces
+ */
+class Output
+{
+public:
+    explicit Output(const std::string& filename)
+        : m_file(filename, std::ios::binary)
+    {
+        if (!m_file) {
+            throw std::runtime_error("can't open " + filename);
+        }
+        m_buffer.reserve(outputBufferSize);
+    }
+
+    void Write(const void* data, size_t size)
+    {
+        const char* bytes = static_cast<const char*>(data);
+        m_buffer.insert(m_buffer.end(), bytes, bytes + size);
+        if (m_buffer.size() >= outputBufferSize) {
+            Flush();
+        }
+    }
+
+    void Number(size_t value, char separator)
+    {
+        char text[24];
+        char* end = std::to_chars(text, text + sizeof(text) - 1, value).ptr;
+        *end++ = separator;
+        Write(text, end - text);
+    }
+
+    void Close()
+    {
+        Flush();
+        m_file.close();
+        if (!m_file) {
+            throw std::runtime_error("can't write the image");
+        }
+    }
+
+private:
+    void Flush()
+    {
+        m_file.write(m_buffer.data(), m_buffer.size());
+        m_buffer.clear();
+    }
+
+    std::ofstream m_file;
+    std::vector<char> m_buffer;
+};
+
+std::uint32_t ReadLittleEndian(const char* bytes)
+{
+    std::uint32_t value = 0;
+    for (size_t i = 0; i < 4; ++i) {
+        value |= std::uint32_t(std::uint8_t(bytes[i])) << (8 * i);
+    }
+    return value;
+}
+
+void WriteLittleEndian(Output& output, size_t value)
+{
+    const char bytes[4] = {char(value), char(value >> 8), char(value >> 16), char(value >> 24)};
+    output.Write(bytes, sizeof(bytes));
+}
+
+/**
+ * Returns number of channel values of the image
+ * @throw std::runtime_error when it doesn't fit into size_t
+ */
+size_t ChannelCount(size_t width, size_t height)
+{
+    if (height != 0 && width > std::numeric_limits<size_t>::max() / Image::channels / height) {
+        throw std::runtime_error("image dimensions are too large");
+    }
+    return width * height * Image::channels;
+}
+
+/**
+ * Builds an image from raw row-major RGB8 pixels
+ */
+Image FromRaw(size_t width, size_t height, const char* pixels, const char* end)
+{
+    const size_t size = ChannelCount(width, height);
+    if (pixels > end || size_t(end - pixels) < size) {
+        throw std::runtime_error("image file is truncated");
+    }
+    std::vector<std::uint8_t> data(pixels, pixels + size);
+    return Image(width, height, width * Image::channels, std::move(data));
+}
+
+void WriteRaw(const Image& image, Output& output)
+{
+    for (size_t rowId = 0; rowId < image.GetHeight(); ++rowId) {
+        output.Write(image.GetRow(rowId), image.GetWidth() * Image::channels);
+    }
+}
+
+Image ReadCSV(const MappedFile& file)
+{
+    Scanner scanner(file.begin(), file.end());
+    const size_t width = scanner.Number();
+    const size_t height = scanner.Number();
+    // Every value takes at least a separator and a digit
+    const size_t count = ChannelCount(width, height);
+    if (count > 0 && size_t(file.end() - scanner.Position()) < 2 * count) {
+        throw std::runtime_error("image file is truncated");
+    }
+    const size_t stride = width * Image::channels;
+    std::vector<std::uint8_t> data(count);
+    for (size_t columnId = 0; columnId < width; ++columnId) {
+        for (size_t rowId = 0; rowId < height; ++rowId) {
+            std::uint8_t* pixel = data.data() + rowId * stride + columnId * Image::channels;
+            for (size_t channel = 0; channel < Image::channels; ++channel) {
+                pixel[channel] = scanner.Channel();
+            }
+        }
+    }
+    return Image(width, height, stride, std::move(data));
+}
+
+void WriteCSV(const Image& image, Output& output)
+{
+    output.Number(image.GetWidth(), ' ');
+    output.Number(image.GetHeight(), '\n');
+    for (size_t columnId = 0; columnId < image.GetWidth(); ++columnId) {
+        for (size_t rowId = 0; rowId < image.GetHeight(); ++rowId) {
+            const std::uint8_t* pixel = image.GetRow(rowId) + columnId * Image::channels;
+            output.Number(pixel[0], ' ');
+            output.Number(pixel[1], ' ');
+            output.Number(pixel[2], '\n');
+        }
+    }
+}
+
+Image ReadPPM(const MappedFile& file)
+{
+    if (file.end() - file.begin() < 2 || std::memcmp(file.begin(), "P6", 2) != 0) {
+        throw std::runtime_error("not a binary PPM image");
+    }
+    Scanner scanner(file.begin() + 2, file.end());
+    const size_t width = scanner.Number(true);
+    const size_t height = scanner.Number(true);
+    if (scanner.Number(true) != 255) {
+        throw std::runtime_error("only 8-bit PPM images are supported");
+    }
+    // A single whitespace character separates the header from the pixels
+    return FromRaw(width, height, scanner.Position() + 1, file.end());
+}
+
+void WritePPM(const Image& image, Output& output)
+{
+    output.Write("P6\n", 3);
+    output.Number(image.GetWidth(), ' ');
+    output.Number(image.GetHeight(), '\n');
+    output.Number(255, '\n');
+    WriteRaw(image, output);
+}
+
+Image ReadRGB8(const MappedFile& file)
+{
+    const size_t headerSize = sizeof(rgb8Magic) + 8;
+    if (size_t(file.end() - file.begin()) < headerSize || std::memcmp(file.begin(), rgb8Magic, sizeof(rgb8Magic)) != 0) {
+        throw std::runtime_error("not an RGB8 image");
+    }
+    const size_t width = ReadLittleEndian(file.begin() + 4);
+    const size_t height = ReadLittleEndian(file.begin() + 8);
+    return FromRaw(width, height, file.begin() + headerSize, file.end());
+}
+
+void WriteRGB8(const Image& image, Output& output)
+{
+    output.Write(rgb8Magic, sizeof(rgb8Magic));
+    WriteLittleEndian(output, image.GetWidth());
+    WriteLittleEndian(output, image.GetHeight());
+    WriteRaw(image, output);
+}
+
+} // namespace
+
+ImageFormat GetImageFormat(const std::string& filename)
+{
+    const size_t dot = filename.rfind('.');
+    const std::string extension = dot == std::string::npos ? "" : filename.substr(dot + 1);
+    if (extension == "ppm") {
+        return ImageFormat::PPM;
+    }
+    if (extension == "rgb8") {
+        return ImageFormat::RGB8;
+    }
+    return ImageFormat::CSV;
+}
+
+Image ReadImage(const std::string& filename, ImageFormat format)
+{
+    const MappedFile file(filename);
+    switch (format) {
+    case ImageFormat::PPM:
+        return ReadPPM(file);
+    case ImageFormat::RGB8:
+        return ReadRGB8(file);
+    default:
+        return ReadCSV(file);
+    }
+}
+
+void WriteImage(const Image& image, const std::string& filename, ImageFormat format)
+{
+    Output output(filename);
+    switch (format) {
+    case ImageFormat::PPM:
+        WritePPM(image, output);
+        break;
+    case ImageFormat::RGB8:
+        WriteRGB8(image, output);
+        break;
+    default:
+        WriteCSV(image, output);
+    }
+    output.Close();
+}
@@ -0,0 +1,43 @@
+#include "Parallel.h"
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+size_t ParallelThreads(size_t threads)
+{
+    return threads == 0 ? std::max(1u, std::thread::hardware_concurrency()) : threads;
+}
+
+void ParallelFor(size_t count, size_t grain, const std::function<void(size_t begin, size_t end)>& body, size_t threads)
+{
+    threads = std::min(ParallelThreads(threads), std::max(size_t(1), count / std::max(grain, size_t(1))));
+    if (threads == 1) {
+        body(0, count);
+        return;
+    }
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < threads; ++i) {
+        workers.emplace_back(body, count * i / threads, count * (i + 1) / threads);
+    }
+    body(0, count / threads);
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+Barrier::Barrier(size_t count)
+    : m_count(count)
+{}
+
+void Barrier::Wait()
+{
+    const size_t phase = m_phase.load(std::memory_order_acquire);
+    if (m_waiting.fetch_add(1, std::memory_order_acq_rel) + 1 == m_count) {
+        m_waiting.store(0, std::memory_order_relaxed);
+        m_phase.fetch_add(1, std::memory_order_release);
+        return;
+    }
+    while (m_phase.load(std::memory_order_acquire) == phase) {
+        std::this_thread::yield();
+    }
+}
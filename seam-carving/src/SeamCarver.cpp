@@ -1,11 +1,38 @@
 #include "SeamCarver.h"
-#include <math.h>
+#include "Energy.h"
+#include "Parallel.h"
+#include "SeamSearch.h"
 #include <algorithm>
 #include <iostream>
 
-SeamCarver::SeamCarver(Image image)
+namespace {
+
+// Fewest cells of a step worth a thread of the seam search: relaxing them
+// takes about a microsecond, a few times the cost of the barrier after every step
+const size_t minStripWidth = 512;
+
+// Side of the square tiles the energies are transposed in
+const size_t transposeTile = 32;
+
+} // namespace
+
+SeamCarver::SeamCarver(Image image, size_t threads)
     : m_image(std::move(image))
-{}
+    , m_energy(GetImageWidth() * GetImageHeight())
+    , m_energyStride(GetImageWidth())
+    , m_threads(threads)
+{
+    if (GetImageWidth() == 0) {
+        return;
+    }
+    // Rows are independent, a thread gets enough of them to outweigh its start
+    const size_t grain = std::max(size_t(1), (size_t(1) << 16) / GetImageWidth());
+    ParallelFor(GetImageHeight(), grain, [this](size_t begin, size_t end) {
+        for (size_t rowId = begin; rowId < end; ++rowId) {
+            UpdateRowEnergy(rowId, 0, GetImageWidth() - 1);
+        }
+    }, m_threads);
+}
 
 const Image& SeamCarver::GetImage() const
 {
@@ -24,107 +51,137 @@ size_t SeamCarver::GetImageHeight() const
 
 double SeamCarver::GetPixelEnergy(size_t columnId, size_t rowId) const
 {
-    size_t width = GetImageWidth();
-    size_t height = GetImageHeight();
-    const Image::Pixel& x1 = m_image.GetPixel((columnId + width - 1) % width, rowId);
-    const Image::Pixel& x2 = m_image.GetPixel((columnId + 1) % width, rowId);
-    const Image::Pixel& y1 = m_image.GetPixel(columnId,(rowId - 1 + height) % height);
-    const Image::Pixel& y2 = m_image.GetPixel(columnId, (rowId + 1) % height);
-    double energyX, energyY;
-    energyX = pow(x1.m_red - x2.m_red, 2) + pow(x1.m_green - x2.m_green, 2) + pow(x1.m_blue - x2.m_blue, 2);
-    energyY = pow(y1.m_red - y2.m_red, 2) + pow(y1.m_green - y2.m_green, 2) + pow(y1.m_blue - y2.m_blue, 2);
-    return sqrt(energyX + energyY);
+    return m_energy[rowId * m_energyStride + columnId];
 }
 
-SeamCarver::Seam SeamCarver::FindHorizontalSeam() const {
-    std::vector<std::vector<double>> minCost(GetImageWidth(), std::vector<double>(GetImageHeight()));
-    std::vector<std::vector<size_t>> parent(GetImageWidth(), std::vector<size_t>(GetImageHeight()));
-    std::vector<int> d = {-1, 0, 1};
-    Seam ans;
-    for (size_t rowId = 0; rowId < GetImageHeight(); ++rowId) {
-        for (size_t columnId = 0; columnId < GetImageWidth(); ++columnId) {
-            minCost[columnId][rowId] = GetPixelEnergy(columnId, rowId);
-        }
-    }
-    for (size_t columnId = 1; columnId < GetImageWidth(); ++columnId) {
-        for (size_t rowId = 0; rowId < GetImageHeight(); ++rowId) {
-            double m = 1e4;
-            for (size_t i = 0; i < 3; ++i) {
-                if (rowId + d[i] < GetImageHeight() && m > minCost[columnId - 1][rowId + d[i]]) {
-                    m = minCost[columnId - 1][rowId + d[i]];
-                    parent[columnId][rowId] = rowId + d[i];
+SeamCarver::Seam SeamCarver::FindHorizontalSeam() const
+{
+    const size_t width = GetImageWidth();
+    const size_t height = GetImageHeight();
+    // Energies transposed so that horizontal seams are searched row by row too
+    std::vector<double> transposed(width * height);
+    const size_t tiles = (height + transposeTile - 1) / transposeTile;
+    ParallelFor(tiles, std::max(size_t(1), (size_t(1) << 16) / (transposeTile * std::max(width, size_t(1)))),
+                [this, width, height, &transposed](size_t begin, size_t end) {
+        for (size_t top = begin * transposeTile; top < std::min(end * transposeTile, height); top += transposeTile) {
+            for (size_t left = 0; left < width; left += transposeTile) {
+                for (size_t rowId = top; rowId < std::min(top + transposeTile, height); ++rowId) {
+                    for (size_t columnId = left; columnId < std::min(left + transposeTile, width); ++columnId) {
+                        transposed[columnId * height + rowId] = m_energy[rowId * m_energyStride + columnId];
+                    }
                 }
             }
-            minCost[columnId][rowId] += m;
-        }
-    }
-    size_t minInLastColumn = 0;
-    for (size_t rowId = 0; rowId < GetImageHeight(); rowId++) {
-        if (minCost[GetImageWidth() - 1][minInLastColumn] > minCost[GetImageWidth() - 1][rowId]) {
-            minInLastColumn = rowId;
         }
-    }
-    ans.push_back(minInLastColumn);
-    size_t row = minInLastColumn;
-    size_t column = GetImageWidth() - 1;
-    while (column != 0) {
-        row = parent[column][row];
-        column--;
-        ans.push_back(row);
-    }
-    std::reverse(ans.begin(), ans.end());
-    return ans;
+    }, m_threads);
+    return FindSeam(transposed.data(), width, height, height);
 }
 
 SeamCarver::Seam SeamCarver::FindVerticalSeam() const
 {
-    std::vector<std::vector<double>> minCost(GetImageWidth(), std::vector<double>(GetImageHeight()));
-    std::vector<std::vector<size_t>> parent(GetImageWidth(), std::vector<size_t>(GetImageHeight()));
-    std::vector<int> d = {-1, 0, 1};
+    return FindSeam(m_energy.data(), GetImageHeight(), GetImageWidth(), m_energyStride);
+}
+
+SeamCarver::Seam SeamCarver::FindSeam(const double* energy, size_t length, size_t breadth, size_t stride) const
+{
     Seam ans;
-    for (size_t columnId = 0; columnId < GetImageWidth(); ++columnId) {
-        for (size_t rowId = 0; rowId < GetImageHeight(); ++rowId) {
-            minCost[columnId][rowId] = GetPixelEnergy(columnId, rowId);
-        }
+    if (length == 0 || breadth == 0) {
+        return ans;
     }
-    for (size_t rowId = 1; rowId < GetImageHeight(); ++rowId) {
-        for (size_t columnId = 0; columnId < GetImageWidth(); ++columnId) {
-            double m = 1e4;
-            for (size_t i = 0; i < 3; ++i) {
-                if (columnId + d[i] < GetImageWidth()) {
-                    if (m > minCost[columnId + d[i]][rowId - 1]) {
-                        m = minCost[columnId + d[i]][rowId - 1];
-                        parent[columnId][rowId] = columnId + d[i];
-                    }
-                }
-            }
-            minCost[columnId][rowId] += m;
-        }
-    }
-    size_t minInLastRow = 0;
-    for (size_t columnId = 0; columnId < GetImageWidth(); ++columnId) {
-        if (minCost[minInLastRow][GetImageHeight() - 1] > minCost[columnId][GetImageHeight() - 1]) {
-            minInLastRow = columnId;
+    // Two rolling rows of cumulative costs and the parent offset (-1, 0, +1) of every cell
+    std::vector<double> cost(2 * breadth);
+    std::vector<std::int8_t> parents(length * breadth);
+    std::copy(energy, energy + breadth, cost.begin());
+
+    // Every thread relaxes its own strip of cells, steps are separated by a barrier
+    const size_t strips = std::max(size_t(1), std::min(ParallelThreads(m_threads), breadth / minStripWidth));
+    Barrier barrier(strips);
+    ParallelFor(strips, 1, [&](size_t strip, size_t) {
+        // As many threads as strips, so every thread gets exactly one
+        const size_t first = breadth * strip / strips;
+        const size_t last = breadth * (strip + 1) / strips;
+        double* previous = cost.data();
+        double* current = previous + breadth;
+        for (size_t step = 1; step < length; ++step) {
+            RelaxRow(previous, energy + step * stride, breadth, first, last, current, parents.data() + step * breadth);
+            std::swap(previous, current);
+            barrier.Wait();
         }
+    }, strips);
+
+    const double* costs = cost.data() + (length % 2 == 0 ? breadth : 0);
+    size_t cell = std::min_element(costs, costs + breadth) - costs;
+    ans.resize(length);
+    for (size_t step = length - 1; step > 0; --step) {
+        ans[step] = cell;
+        cell += parents[step * breadth + cell];
     }
-    ans.push_back(minInLastRow);
-    size_t row = GetImageHeight() - 1;
-    size_t column = minInLastRow;
-    while (row != 0) {
-        column = parent[column][row];
-        row--;
-        ans.push_back(column);
-    }
-    std::reverse(ans.begin(), ans.end());
+    ans[0] = cell;
     return ans;
 }
 
+void SeamCarver::UpdateColumnEnergy(size_t columnId, size_t first, size_t last)
+{
+    for (size_t rowId = first; rowId <= last; ++rowId) {
+        UpdateRowEnergy(rowId, columnId, columnId);
+    }
+}
+
+void SeamCarver::UpdateRowEnergy(size_t rowId, size_t first, size_t last)
+{
+    const size_t height = GetImageHeight();
+    ComputeRowEnergy(m_image.GetRow((rowId + height - 1) % height), m_image.GetRow(rowId),
+                     m_image.GetRow((rowId + 1) % height), GetImageWidth(), first, last, &Energy(0, rowId));
+}
+
 void SeamCarver::RemoveHorizontalSeam(const Seam& seam)
 {
     m_image.RemoveHorizontalSeam(seam);
+    const size_t width = GetImageWidth();
+    const size_t height = GetImageHeight();
+    for (size_t rowId = 0; rowId < height; ++rowId) {
+        for (size_t columnId = 0; columnId < width; ++columnId) {
+            if (seam[columnId] <= rowId) {
+                Energy(columnId, rowId) = Energy(columnId, rowId + 1);
+            }
+        }
+    }
+    if (height == 0) {
+        return;
+    }
+    // A pixel changes its energy when one of its neighbours is replaced: next to the seam
+    // in its column, or where the seams of the neighbouring columns differ. The first and
+    // the last rows are neighbours through the wrap around
+    for (size_t columnId = 0; columnId < width; ++columnId) {
+        const size_t previous = seam[(columnId + width - 1) % width];
+        const size_t next = seam[(columnId + 1) % width];
+        const size_t low = std::min({previous, seam[columnId], next});
+        const size_t high = std::max({previous, seam[columnId], next});
+        UpdateColumnEnergy(columnId, low == 0 ? 0 : low - 1, std::min(high, height - 1));
+        UpdateColumnEnergy(columnId, 0, 0);
+        UpdateColumnEnergy(columnId, height - 1, height - 1);
+    }
 }
 
 void SeamCarver::RemoveVerticalSeam(const Seam& seam)
 {
     m_image.RemoveVerticalSeam(seam);
+    const size_t width = GetImageWidth();
+    const size_t height = GetImageHeight();
+    for (size_t rowId = 0; rowId < height; ++rowId) {
+        double* row = &Energy(0, rowId);
+        std::copy(row + seam[rowId] + 1, row + width + 1, row + seam[rowId]);
+    }
+    if (width == 0) {
+        return;
+    }
+    // Same neighbourhood as for a horizontal seam, with rows and columns swapped
+    for (size_t rowId = 0; rowId < height; ++rowId) {
+        const size_t previous = seam[(rowId + height - 1) % height];
+        const size_t next = seam[(rowId + 1) % height];
+        const size_t low = std::min({previous, seam[rowId], next});
+        const size_t high = std::max({previous, seam[rowId], next});
+        UpdateRowEnergy(rowId, low == 0 ? 0 : low - 1, std::min(high, width - 1));
+        UpdateRowEnergy(rowId, 0, 0);
+        UpdateRowEnergy(rowId, width - 1, width - 1);
+    }
 }
@@ -0,0 +1,99 @@
+#include "SeamSearch.h"
+#include <algorithm>
+#include <cstring>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace {
+
+void RelaxCell(const double* previous, const double* energy, size_t breadth, size_t cell,
+               double* current, std::int8_t* parent)
+{
+    double best = previous[cell];
+    parent[cell] = 0;
+    if (cell > 0 && previous[cell - 1] <= best) {
+        best = previous[cell - 1];
+        parent[cell] = -1;
+    }
+    if (cell + 1 < breadth && previous[cell + 1] < best) {
+        best = previous[cell + 1];
+        parent[cell] = 1;
+    }
+    current[cell] = energy[cell] + best;
+}
+
+#if defined(__AVX2__) || defined(__SSE2__)
+/**
+ * Parent offsets of the lanes packed into bytes, indexed by the comparison masks:
+ * bits of the left one are low, bits of the right one start at `lanes`
+ */
+template <size_t lanes>
+struct ParentTable
+{
+    ParentTable()
+    {
+        for (unsigned left = 0; left < (1u << lanes); ++left) {
+            for (unsigned right = 0; right < (1u << lanes); ++right) {
+                for (size_t lane = 0; lane < lanes; ++lane) {
+                    const bool isRight = (right >> lane) & 1;
+                    const bool isLeft = (left >> lane) & 1;
+                    offsets[left | (right << lanes)][lane] = isRight ? 1 : isLeft ? -1 : 0;
+                }
+            }
+        }
+    }
+
+    std::int8_t offsets[1u << (2 * lanes)][lanes];
+};
+#endif
+
+} // namespace
+
+void RelaxRow(const double* previous, const double* energy, size_t breadth, size_t first, size_t last,
+              double* current, std::int8_t* parent)
+{
+    // Edge cells miss a parent, the inner ones are relaxed without bounds checks
+    if (first == 0 && last > 0) {
+        RelaxCell(previous, energy, breadth, 0, current, parent);
+    }
+    if (breadth > 1 && first < breadth && last == breadth) {
+        RelaxCell(previous, energy, breadth, breadth - 1, current, parent);
+    }
+    size_t cell = std::max(first, size_t(1));
+    const size_t end = std::min(last, breadth - 1);
+#if defined(__AVX2__)
+    static const ParentTable<4> table;
+    for (; cell + 4 <= end; cell += 4) {
+        const __m256d left = _mm256_loadu_pd(previous + cell - 1);
+        const __m256d middle = _mm256_loadu_pd(previous + cell);
+        const __m256d right = _mm256_loadu_pd(previous + cell + 1);
+        const __m256d isLeft = _mm256_cmp_pd(left, middle, _CMP_LE_OQ);
+        __m256d best = _mm256_blendv_pd(middle, left, isLeft);
+        const __m256d isRight = _mm256_cmp_pd(right, best, _CMP_LT_OQ);
+        best = _mm256_blendv_pd(best, right, isRight);
+        _mm256_storeu_pd(current + cell, _mm256_add_pd(_mm256_loadu_pd(energy + cell), best));
+        std::memcpy(parent + cell, table.offsets[_mm256_movemask_pd(isLeft) | (_mm256_movemask_pd(isRight) << 4)], 4);
+    }
+#elif defined(__SSE2__)
+    static const ParentTable<2> table;
+    auto blend = [](__m128d mask, __m128d whenFalse, __m128d whenTrue) {
+        return _mm_or_pd(_mm_and_pd(mask, whenTrue), _mm_andnot_pd(mask, whenFalse));
+    };
+    for (; cell + 2 <= end; cell += 2) {
+        const __m128d left = _mm_loadu_pd(previous + cell - 1);
+        const __m128d middle = _mm_loadu_pd(previous + cell);
+        const __m128d right = _mm_loadu_pd(previous + cell + 1);
+        const __m128d isLeft = _mm_cmple_pd(left, middle);
+        __m128d best = blend(isLeft, middle, left);
+        const __m128d isRight = _mm_cmplt_pd(right, best);
+        best = blend(isRight, best, right);
+        _mm_storeu_pd(current + cell, _mm_add_pd(_mm_loadu_pd(energy + cell), best));
+        std::memcpy(parent + cell, table.offsets[_mm_movemask_pd(isLeft) | (_mm_movemask_pd(isRight) << 2)], 2);
+    }
+#endif
+    for (; cell < end; ++cell) {
+        RelaxCell(previous, energy, breadth, cell, current, parent);
+    }
+}
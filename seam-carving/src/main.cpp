@@ -1,44 +1,10 @@
 #include <iostream>
-#include <fstream>
+#include <stdexcept>
 
 #include "Image.h"
+#include "ImageIO.h"
 #include "SeamCarver.h"
 
-static std::vector<std::vector<Image::Pixel>> ReadImageFromCSV(std::ifstream& input)
-{
-    size_t width, height;
-    input >> width >> height;
-    std::vector<std::vector<Image::Pixel>> table;
-    for (size_t columnId = 0; columnId < width; ++columnId)
-    {
-        std::vector<Image::Pixel> column;
-        for (size_t rowId = 0; rowId < height; ++rowId)
-        {
-            size_t red, green, blue;
-            input >> red >> green >> blue;
-            column.emplace_back(red, green, blue);
-        }
-        table.emplace_back(std::move(column));
-    }
-    return table;
-}
-
-static void WriteImageToCSV(const SeamCarver& carver, std::ofstream& output)
-{
-    const size_t width = carver.GetImageWidth();
-    const size_t height = carver.GetImageHeight();
-    output << width << " " << height << "\n";
-    const Image& image = carver.GetImage();
-    for (size_t columnId = 0; columnId < width; ++columnId)
-    {
-        for (size_t rowId = 0; rowId < height; ++rowId)
-        {
-            const Image::Pixel& pixel = image.GetPixel(columnId, rowId);
-            output << pixel.m_red << " " << pixel.m_green << " " << pixel.m_blue << std::endl;
-        }
-    }
-}
-
 int main(int argc, char* argv[])
 {
     // Check command line arguments
@@ -46,30 +12,29 @@ int main(int argc, char* argv[])
     if (argc != expectedAmountOfArgs)
     {
         std::cout << "Wrong amount of arguments. Provide filenames as arguments. See example below:\n";
-        std::cout << "seam-carving data/tower.csv data/tower_updated.csv" << std::endl;
+        std::cout << "seam-carving data/tower.csv data/tower_updated.csv\n";
+        std::cout << "Files ending with .ppm are binary PPM images, with .rgb8 raw RGB8 images, other files are CSV." << std::endl;
         return 0;
     }
-    // Check csv file
-    std::ifstream inputFile(argv[1]);
-    if (!inputFile.good())
+    try
     {
-        std::cout << "Can't open source file " << argv[1] << ". Verify that the file exists." << std::endl;
-    }
-    else
-    {
-        auto imageSource = ReadImageFromCSV(inputFile);
-        SeamCarver carver(std::move(imageSource));
-        std::cout << "Image: " << carver.GetImageWidth() << "x" << carver.GetImageHeight() << std::endl;
+        SeamCarver carver(ReadImage(argv[1], GetImageFormat(argv[1])));
+        std::cout << "Image: " << carver.GetImageWidth() << "x" << carver.GetImageHeight() << "\n";
         const size_t pixelsToDelete = 150;
-        for (size_t i = 0; i < pixelsToDelete; ++i)
+        for (size_t i = 0; i < pixelsToDelete && carver.GetImageWidth() > 1; ++i)
         {
             std::vector<size_t> seam = carver.FindVerticalSeam();
             carver.RemoveVerticalSeam(seam);
-            std::cout << "width = " << carver.GetImageWidth() << ", height = " << carver.GetImageHeight() << std::endl;
+            std::cout << "width = " << carver.GetImageWidth() << ", height = " << carver.GetImageHeight() << "\n";
         }
-        std::ofstream outputFile(argv[2]);
-        WriteImageToCSV(carver, outputFile);
+        WriteImage(carver.GetImage(), argv[2], GetImageFormat(argv[2]));
         std::cout << "Updated image is written to " << argv[2] << "." << std::endl;
     }
+    catch (const std::exception& error)
+    {
+        // ReadImage reports a missing or unreadable source file as well
+        std::cout << "Can't process " << argv[1] << ": " << error.what() << "." << std::endl;
+        return 1;
+    }
     return 0;
-}
\ No newline at end of file
+}